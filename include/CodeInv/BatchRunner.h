@@ -0,0 +1,97 @@
+//===--- BatchRunner - Run many jobs in isolated workers --------*- C++ -*-===//
+//
+//              Fracture: The Draper Decompiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Runs a list of jobs (e.g., one per binary) on a pool of pre-forked worker
+// processes. Workers are forked after the caller initialized the LLVM
+// targets, and stay alive across jobs, so per-target state (MCDirectors,
+// Disassemblers) is built once per worker rather than once per job.
+//
+// A job that crashes, hits report_fatal_error or runs past the timeout only
+// takes down its worker; the job is recorded as such and a new worker is
+// forked in its place.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef BATCHRUNNER_H
+#define BATCHRUNNER_H
+
+#include "llvm/Support/raw_ostream.h"
+
+#include <functional>
+#include <string>
+#include <vector>
+
+using namespace llvm;
+
+namespace fracture {
+
+class BatchRunner {
+public:
+  enum Status { Success, Failed, FatalError, Crashed, TimedOut };
+
+  struct Result {
+    Status JobStatus;
+    std::string Message;
+    /// Output the job passes back to the caller as is (e.g., JSON).
+    std::string Data;
+    double Seconds;
+  };
+
+  /// Runs job Index inside a worker. Returns false, with a reason in
+  /// Message, if the job failed. Data is returned in the job's Result.
+  typedef std::function<bool(unsigned Index, std::string &Message,
+    std::string &Data)> JobFn;
+
+  /// Fills in Data for a job that hit report_fatal_error, from inside the
+  /// worker, before it exits (e.g., with the counts made up to the error).
+  typedef std::function<void(std::string &Data)> FatalDataFn;
+
+  /// \param NumWorkers - worker processes to run. With 0, jobs run in the
+  ///                     calling process with no isolation or timeout.
+  /// \param TimeoutSeconds - per job limit, 0 for none.
+  BatchRunner(unsigned NumWorkers, unsigned TimeoutSeconds,
+    raw_ostream &ErrOut = nulls());
+
+  /// \brief Runs jobs 0 to NumJobs - 1, and returns their results in job
+  /// order.
+  void run(unsigned NumJobs, JobFn Job, std::vector<Result> &Results);
+
+  /// \brief Sets the data returned for jobs that end in a fatal error.
+  /// Without it, their Data is empty.
+  void setFatalData(FatalDataFn Fn) { FatalData = Fn; }
+
+  static const char *getStatusName(Status S);
+
+private:
+  struct Worker {
+    int Pid;
+    int ToWorker, FromWorker;
+    int Job;
+    double Start;
+  };
+
+  unsigned NumWorkers, Timeout;
+  FatalDataFn FatalData;
+  std::vector<Worker> Workers;
+
+  bool spawn(Worker &W, JobFn &Job);
+  void reap(Worker &W, Result &R);
+  void runWorker(int In, int Out, JobFn &Job);
+
+  /// Error printing
+  raw_ostream &Errs;
+  void printError(std::string Msg) const {
+    Errs << "BatchRunner: " << Msg << "\n";
+    Errs.flush();
+  }
+};
+
+} // end namespace fracture
+
+#endif /* BATCHRUNNER_H */
@@ -0,0 +1,92 @@
+//===--- CompactCFG - Compressed sparse row control flow graph --*- C++ -*-===//
+//
+//              Fracture: The Draper Decompiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This class holds a control flow graph over address ranges in compressed
+// sparse row form: blocks live in one array sorted by address and the
+// successor and predecessor edges of block i are the slices
+// [Offsets[i], Offsets[i+1]) of flat index arrays. A block costs roughly 32
+// bytes and an edge 8, so graphs with millions of blocks stay small.
+//
+// The graph is built by adding blocks and edges (by address) and then calling
+// finalize(). All traversals are iterative.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef COMPACTCFG_H
+#define COMPACTCFG_H
+
+#include "llvm/ADT/ArrayRef.h"
+
+#include <inttypes.h>
+#include <utility>
+#include <vector>
+
+using namespace llvm;
+
+namespace fracture {
+
+class CompactCFG {
+public:
+  typedef uint32_t NodeID;
+  static const NodeID InvalidNode = ~0U;
+
+  CompactCFG() : Finalized(false) {}
+
+  /// \brief Add a block covering [Start, End). Blocks may not overlap.
+  void addBlock(uint64_t Start, uint64_t End);
+  /// \brief Add an edge from the block holding From to the block holding To.
+  /// Edges to addresses outside of every block are dropped by finalize().
+  void addEdge(uint64_t From, uint64_t To);
+  /// \brief Sort the blocks and build the edge arrays. No blocks or edges can
+  /// be added afterwards.
+  void finalize();
+  bool isFinalized() const { return Finalized; }
+
+  unsigned size() const { return Starts.size(); }
+  unsigned getNumEdges() const { return Succs.size(); }
+  uint64_t getStart(NodeID N) const { return Starts[N]; }
+  uint64_t getEnd(NodeID N) const { return Ends[N]; }
+
+  /// \brief Returns the block holding Address, or InvalidNode.
+  NodeID findBlock(uint64_t Address) const;
+
+  ArrayRef<NodeID> successors(NodeID N) const {
+    return makeArrayRef(Succs.data() + SuccOffsets[N],
+      SuccOffsets[N + 1] - SuccOffsets[N]);
+  }
+  ArrayRef<NodeID> predecessors(NodeID N) const {
+    return makeArrayRef(Preds.data() + PredOffsets[N],
+      PredOffsets[N + 1] - PredOffsets[N]);
+  }
+
+  /// \brief Blocks reachable from Entry in depth first preorder.
+  void depthFirst(NodeID Entry, std::vector<NodeID> &Order) const;
+  /// \brief Blocks reachable from Entry in reverse postorder.
+  void reversePostOrder(NodeID Entry, std::vector<NodeID> &Order) const;
+  /// \brief Immediate dominators of the blocks reachable from Entry, indexed
+  /// by NodeID. Entry is its own idom, unreachable blocks get InvalidNode.
+  void computeDominators(NodeID Entry, std::vector<NodeID> &IDom) const;
+  /// \brief Returns true if A dominates B, given the result of
+  /// computeDominators.
+  static bool dominates(const std::vector<NodeID> &IDom, NodeID A, NodeID B);
+
+private:
+  bool Finalized;
+  std::vector<uint64_t> Starts, Ends;
+  std::vector<uint32_t> SuccOffsets, PredOffsets;
+  std::vector<NodeID> Succs, Preds;
+  /// Edges by address, only used until finalize().
+  std::vector<std::pair<uint64_t, uint64_t> > PendingEdges;
+
+  void postOrder(NodeID Entry, std::vector<NodeID> &Order) const;
+};
+
+} // end namespace fracture
+
+#endif /* COMPACTCFG_H */
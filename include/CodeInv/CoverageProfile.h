@@ -0,0 +1,80 @@
+//===--- CoverageProfile - Unhandled node profile ---------------*- C++ -*-===//
+//
+//              Fracture: The Draper Decompiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Records the nodes the emitters could not lower when the Decompiler runs in
+// coverage mode (see Decompiler::setCoverageProfile). Instead of aborting,
+// each miss is counted by (target, instruction, node kind) together with a few
+// of the addresses it was seen at, and the lift goes on. Printing ranks the
+// misses by how often they were hit, so a run over a corpus gives the list of
+// missing lowerings worth implementing first.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef COVERAGEPROFILE_H
+#define COVERAGEPROFILE_H
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <stdint.h>
+#include <vector>
+
+using namespace llvm;
+
+namespace fracture {
+
+class CoverageProfile {
+public:
+  /// Sample addresses kept per entry.
+  static const unsigned MaxAddresses = 8;
+
+  struct Entry {
+    std::string Target;
+    /// Name of the machine instruction the node came from, if known.
+    std::string Opcode;
+    /// Name of the node the emitter could not handle, e.g. "sdiv".
+    std::string Node;
+    uint64_t Count;
+    std::vector<uint64_t> Addresses;
+  };
+
+  CoverageProfile() : Total(0) {}
+
+  void record(StringRef Target, StringRef Opcode, StringRef Node,
+    uint64_t Address);
+
+  bool empty() const { return Entries.empty(); }
+  uint64_t getTotal() const { return Total; }
+  void clear();
+
+  /// \brief Returns the entries, most frequent first.
+  void getRanked(std::vector<const Entry*> &Ranked) const;
+
+  /// \brief Prints one "count target instruction node addresses" line per
+  /// entry, most frequent first.
+  void print(raw_ostream &Out) const;
+  /// \brief Writes a JSON array of the entries, most frequent first.
+  void writeJSON(raw_ostream &Out) const;
+  /// \brief Adds the entries of text written by print. Returns false if a
+  /// line could not be parsed.
+  bool read(StringRef Text);
+
+private:
+  void add(StringRef Target, StringRef Opcode, StringRef Node, uint64_t Count,
+    ArrayRef<uint64_t> Addresses);
+
+  /// Keyed by target, opcode and node, separated by NULs.
+  StringMap<Entry> Entries;
+  uint64_t Total;
+};
+
+} // end namespace fracture
+
+#endif /* COVERAGEPROFILE_H */
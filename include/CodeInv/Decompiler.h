@@ -16,7 +16,9 @@
 #ifndef DECOMPILER_H
 #define DECOMPILER_H
 
+#include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/IndexedMap.h"
+#include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/CodeGen/ISDOpcodes.h"
 #include "llvm/CodeGen/SelectionDAGNodes.h"
 #include "llvm/CodeGen/MachineModuleInfo.h"
@@ -35,7 +37,12 @@
 #include "llvm/PassManager.h"
 
 #include "CodeInv/InvISelDAG.h"
+#include "CodeInv/CoverageProfile.h"
+#include "CodeInv/DecompilerListener.h"
 #include "CodeInv/Disassembler.h"
+#include "CodeInv/ModuleWriter.h"
+#include "CodeInv/OptPipeline.h"
+#include "CodeInv/RegisterSSA.h"
 #include "Transforms/TypeRecovery.h"
 
 #include "CodeInv/InvISelDAG.h"
@@ -51,6 +58,10 @@ public:
     raw_ostream &InfoOut = nulls(), raw_ostream &ErrOut = nulls());
   ~Decompiler();
 
+  /// \brief Drop the decompiled module and start over with a fresh one. Call
+  /// this after pointing the Disassembler at a new executable.
+  void reset();
+
   void printInstructions(formatted_raw_ostream &Out, unsigned Address);
 
   ///===-------------------------------------------------------------------===//
@@ -65,7 +76,35 @@ public:
   /// @param Address - the address to start decompiling.
   ///
   void decompile(unsigned Address);
-  Function* decompileFunction(unsigned Address);
+
+  ///===-------------------------------------------------------------------===//
+  /// decompileLazy - decompile only the function at a given memory address.
+  ///
+  /// Callees are named but left as declarations carrying an "Address"
+  /// attribute, see materialize. The time this takes does not depend on the
+  /// size of the call graph below the function.
+  ///
+  /// @param Address - the address of the function.
+  ///
+  Function* decompileLazy(unsigned Address);
+
+  /// \brief Returns true if F is a callee declaration that can be decompiled
+  /// and has not failed to before.
+  bool isMaterializable(const Function *F) const;
+  /// \brief Decompile the body of a declaration left by decompileLazy into F
+  /// itself. Its own callees are left as declarations. Returns F; it stays a
+  /// declaration if there is nothing to do or its address cannot be
+  /// decompiled, e.g. a library call, which is not tried again.
+  Function* materialize(Function *F);
+  /// \brief Materialize declarations until none reachable are left, which is
+  /// the same as what decompile does.
+  void materializeAll();
+  /// \brief The value of the "Address" attribute of F, or 0 if it has none.
+  uint64_t getFunctionAddress(const Function *F) const;
+
+  /// \brief Decompiles the function at Address into Into, or, if Into is
+  /// null, into the function named after its machine function.
+  Function* decompileFunction(unsigned Address, Function *Into = NULL);
   BasicBlock* decompileBasicBlock(MachineBasicBlock *MBB, Function *F);
 
   BasicBlock* getOrCreateBasicBlock(unsigned Address, Function *F);
@@ -76,6 +115,11 @@ public:
     BasicBlock::iterator FirstInst, BasicBlock *Tgt);
 
   SelectionDAG* createDAGFromMachineBasicBlock(MachineBasicBlock *MBB);
+  /// \brief Runs the inverse instruction selector over a DAG built by
+  /// createDAGFromMachineBasicBlock.
+  void invertDAG(SelectionDAG *NewDAG);
+  /// \brief Emits IR for an inverted DAG into the block named BBName in F.
+  BasicBlock* emitDAG(SelectionDAG *NewDAG, StringRef BBName, Function *F);
 
   uint64_t getBasicBlockAddress(BasicBlock *BB);
 
@@ -83,6 +127,32 @@ public:
   const Disassembler* getDisassembler() const { return Dis; }
   void setViewMCDAGs(bool Setting) { ViewMCDAGs = Setting; }
   void setViewIRDAGs(bool Setting) { ViewIRDAGs = Setting; }
+  /// \brief Turns on coverage mode when Profile is not null: nodes that
+  /// cannot be inverted or emitted are recorded in Profile and replaced by a
+  /// placeholder call instead of aborting. The caller owns Profile.
+  void setCoverageProfile(CoverageProfile *Profile) { Coverage = Profile; }
+  CoverageProfile* getCoverageProfile() const { return Coverage; }
+  /// \brief Turns on streaming when Streamer is not null: decompile and
+  /// decompileLazy hand every finished function to Streamer and then drop
+  /// its body, leaving a declaration. Functions that already have a body are
+  /// streamed right away. The caller owns Streamer and calls its finish.
+  void setFunctionStreamer(FunctionStreamer *Streamer);
+  FunctionStreamer* getFunctionStreamer() const { return Streamer; }
+  /// \brief Runs Pipeline over every function decompile and decompileLazy
+  /// finish, before it is streamed. Null, the default, leaves the IR as
+  /// emitted. The caller owns Pipeline.
+  void setOptPipeline(OptPipeline *Pipeline) { Optimizer = Pipeline; }
+  OptPipeline* getOptPipeline() const { return Optimizer; }
+  /// \brief With Setting on, the register loads and stores of every
+  /// decompiled function are turned into SSA values (see RegisterSSA).
+  void setRegisterSSA(bool Setting) { UseRegisterSSA = Setting; }
+  /// \brief Tells Listener about every function decompile and decompileLazy
+  /// finish. Listener is not told about reset, so drop it along with the old
+  /// module. The caller owns Listener.
+  void setListener(DecompilerListener *NewListener) { Listener = NewListener; }
+  DecompilerListener* getListener() const { return Listener; }
+  /// \brief Returns true if the body of F was streamed out and dropped.
+  bool isStreamed(const Function *F) const { return Streamed.count(F); }
   Module* getModule() { return Mod; }
 private:
   Disassembler *Dis;
@@ -93,6 +163,30 @@ private:
   bool ViewMCDAGs;
   bool ViewIRDAGs;
   IREmitter *Emitter;
+  CoverageProfile *Coverage;
+  FunctionStreamer *Streamer;
+  OptPipeline *Optimizer;
+  DecompilerListener *Listener;
+  bool UseRegisterSSA;
+  RegisterSSA RegSSA;
+  SmallPtrSet<const Function*, 64> Streamed;
+  /// Addresses materialize could not decompile.
+  DenseSet<uint64_t> FailedAddrs;
+
+  Module* createModule();
+  /// \brief Name the callees of F after their symbols. If Children is not
+  /// null, the addresses of callees without a body are added to it.
+  void resolveCallees(Function *F, unsigned Address,
+    std::vector<unsigned> *Children);
+  /// \brief The name of the block of F for MBB. Blocks are named after F,
+  /// which is not always the name of the machine function, see materialize.
+  std::string getBlockName(const MachineBasicBlock *MBB,
+    const Function *F) const;
+  /// \brief Optimizes a fully lifted F, tells the listener about it and
+  /// streams it, if any of them is on.
+  void finishFunction(Function *F);
+  /// \brief Writes F with the streamer, if any, and drops its body.
+  void streamFunction(Function *F);
 
   void printSDNode(std::map<SDValue, std::string> &OpMap,
     std::stack<SDNode *> &NodeStack, SDNode *CurNode, SelectionDAG *DAG);
@@ -0,0 +1,35 @@
+//===--- DecompilerListener - Hears about decompiled functions --*- C++ -*-===//
+//
+//              Fracture: The Draper Decompiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Interface for clients that keep their own view of the decompiled module,
+// e.g. a call graph, up to date while functions are lifted into it.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef DECOMPILERLISTENER_H
+#define DECOMPILERLISTENER_H
+
+#include "llvm/IR/Function.h"
+
+using namespace llvm;
+
+namespace fracture {
+
+class DecompilerListener {
+public:
+  virtual ~DecompilerListener() {}
+
+  /// \brief Called once the body of F is final, before it is streamed out.
+  /// The body may be dropped right after this returns.
+  virtual void functionDecompiled(Function *F) = 0;
+};
+
+} // end namespace fracture
+
+#endif /* DECOMPILERLISTENER_H */
@@ -49,6 +49,7 @@
 #include <stdio.h>
 #include <algorithm>
 #include <map>
+#include <tuple>
 #include <inttypes.h>
 #include <signal.h>
 #include <sstream>
@@ -136,6 +137,11 @@ public:
   // MCInst* getInst(unsigned Address) const { return Instructions[Address]; }
 
   /// Getters and Setters
+
+  /// \brief Point the Disassembler at a new executable. If one was already
+  /// set, it is deleted along with everything decoded from it and the module,
+  /// so a live Disassembler can be reused for another executable of the same
+  /// target without rebuilding the MCDirector.
   void setExecutable(object::ObjectFile* NewExecutable);
   object::ObjectFile* getExecutable() { return Executable; };
 
@@ -180,8 +186,34 @@ public:
 
   std::map<StringRef, uint64_t> getRelocOrigins() { return RelocOrigins; };
   uint64_t getDebugOffset(const DebugLoc &Loc) const;
+
+  /// \brief Resolves the address a decoded instruction refers to: the
+  /// destination of a direct branch or call, or the address read by a PC
+  /// relative load (ARM literal pools, x86-64 RIP relative operands).
+  ///
+  /// \returns false if the instruction has no target that can be resolved
+  /// statically.
+  bool getInstTarget(const MachineInstr *MI, uint64_t &Target) const;
+  /// \brief Reads a Size byte word (at most 8) at Address in the current
+  /// section, in the target's byte order.
+  bool readWord(uint64_t Address, unsigned Size, uint64_t &Value) const;
+  /// \brief For a PC relative load, reads the pointer sized word it loads.
+  bool getLoadedWord(const MachineInstr *MI, uint64_t &Value) const;
   DebugLoc* setDebugLoc(uint64_t Address);
+  /// \brief Deletes MF along with its instructions. Later requests for its
+  /// addresses decode them again.
   void deleteFunction(MachineFunction* MF);
+
+  /// \brief Caps the memory held by decoded functions at about Bytes, or 0
+  /// for no cap. Nothing is freed until trimToBudget is called.
+  void setMemoryBudget(uint64_t Bytes) { MemoryBudget = Bytes; }
+  uint64_t getMemoryBudget() const { return MemoryBudget; }
+  /// \brief Estimated bytes held by the decoded functions.
+  uint64_t getResidentSize() const { return ResidentSize; }
+  /// \brief Deletes the least recently disassembled functions until they fit
+  /// in the budget. Callers must not keep MachineFunctions or MachineInstrs
+  /// across this call.
+  void trimToBudget();
 private:
   object::SectionRef CurSection;
   object::ObjectFile *Executable;
@@ -192,6 +224,22 @@ private:
   std::map<unsigned, MCInst*> Instructions;
   std::map<unsigned, const MachineInstr*> MachineInstructions;
   std::map<StringRef, uint64_t> RelocOrigins;
+  /// Instruction descriptors by opcode, size and flags. Instructions of the
+  /// same kind share one.
+  std::map<std::tuple<unsigned, uint64_t, uint64_t>, MCInstrDesc*> Descs;
+
+  /// Estimated size and last use of each decoded function.
+  struct FunctionUse {
+    uint64_t Size;
+    uint64_t LastUse;
+  };
+  std::map<MachineFunction*, FunctionUse> FunctionUses;
+  uint64_t MemoryBudget;
+  uint64_t ResidentSize;
+  uint64_t UseClock;
+
+  const MCInstrDesc* getInstrDesc(const MCInstrDesc &Desc);
+  void releaseFunction(MachineFunction *MF);
 
   MachineModuleInfo *MMI;
   GCModuleInfo *GMI;
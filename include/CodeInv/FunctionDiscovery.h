@@ -0,0 +1,143 @@
+//===--- FunctionDiscovery - Finds function extents in a section -*- C++ -*-===//
+//
+//              Fracture: The Draper Decompiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This class finds the functions in a section of code. It runs an iterative
+// recursive descent from the seeds it is given (entry points, symbols and the
+// call targets it finds on the way), then sweeps linearly over the bytes that
+// were not reached and starts a new descent at each instruction it finds
+// there. Every address is decoded at most once, and the result is a map of
+// function start to end addresses for the whole section.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef FUNCTIONDISCOVERY_H
+#define FUNCTIONDISCOVERY_H
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/BitVector.h"
+#include "llvm/MC/MCInst.h"
+#include "llvm/Object/ObjectFile.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <map>
+#include <vector>
+
+#include "CodeInv/CompactCFG.h"
+#include "CodeInv/MCDirector.h"
+#include "CodeInv/StrippedSignatures.h"
+
+using namespace llvm;
+
+namespace fracture {
+
+class Disassembler;
+
+class FunctionDiscovery {
+public:
+  /// Maps function start address to the address just past its last byte.
+  typedef std::map<uint64_t, uint64_t> ExtentMap;
+
+  /// \brief Discover functions in Bytes, which are loaded at Base.
+  FunctionDiscovery(const MCDirector *TheMC, ArrayRef<uint8_t> SectBytes,
+    uint64_t SectBase, raw_ostream &InfoOut = nulls(),
+    raw_ostream &ErrOut = nulls());
+  /// \brief Discover functions in the current section of the Disassembler.
+  FunctionDiscovery(const Disassembler *DAS, raw_ostream &InfoOut = nulls(),
+    raw_ostream &ErrOut = nulls());
+
+  /// \brief Add an address where a function is known to begin.
+  void addSeed(uint64_t Address);
+  /// \brief Add every function symbol of the executable inside the section.
+  void addSymbolSeeds(const object::ObjectFile *Executable);
+  /// \brief Add an address that only looks like a function start, e.g. a
+  /// prologue found by PrologueScanner. Candidates are tried in address
+  /// order once the seeds are done, and dropped if already inside a function.
+  void addCandidate(uint64_t Address);
+
+  /// \brief Find all the functions, starting from the seeds. When Sweep is
+  /// false, only the code reachable from the seeds is found.
+  void run(bool Sweep = true);
+
+  const ExtentMap& getFunctions() const { return Functions; }
+  /// \brief Number of functions that were started from a candidate.
+  unsigned getNumCandidateFunctions() const { return NumFromCandidates; }
+
+  /// \brief Add the basic blocks of every discovered function, and the edges
+  /// between them, to CFG. Call after run(), CFG still needs finalize().
+  void buildCFG(CompactCFG &CFG) const;
+
+  /// \brief Returns the start of the function owning the instruction at
+  /// Address, or ~0ULL if no function does.
+  uint64_t getFunctionAt(uint64_t Address) const;
+
+  /// \brief Decoded instruction accessors, NULL/0 if Address was not decoded.
+  const MCInst* getInst(uint64_t Address) const;
+  unsigned getInstSize(uint64_t Address) const;
+
+  bool contains(uint64_t Address) const {
+    return Address >= Base && Address - Base < Bytes.size();
+  }
+
+private:
+  static const uint64_t NoFunction = ~0ULL;
+
+  struct DecodedInst {
+    MCInst Inst;
+    unsigned Size;
+    uint64_t Function;
+    /// Set during descent: the instruction ends its block, and control can
+    /// fall through to the next instruction.
+    bool EndsBlock, FallsThrough;
+  };
+
+  const MCDirector *MC;
+  /// The target's padding instructions (e.g., NOOP, INT3).
+  StrippedSignatures Sigs;
+  ArrayRef<uint8_t> Bytes;
+  uint64_t Base;
+
+  /// Per byte of the section, the index of the instruction decoded there,
+  /// Undecoded or Invalid.
+  enum { Undecoded = -1, Invalid = -2 };
+  std::vector<int> InstIndex;
+  std::vector<DecodedInst> Insts;
+  /// Per byte of the section, set once an instruction covering it is owned
+  /// by a function.
+  BitVector Covered;
+  /// Per byte of the section, set where a basic block begins.
+  BitVector Leaders;
+  /// Branch edges from the branch address to the target address.
+  std::vector<std::pair<uint64_t, uint64_t> > Edges;
+
+  std::vector<uint64_t> Seeds;
+  std::vector<uint64_t> Candidates;
+  unsigned NumFromCandidates;
+  ExtentMap Functions;
+
+  void init();
+  DecodedInst* decode(uint64_t Address);
+  bool isPadding(uint64_t Address, const DecodedInst &DI) const;
+  void processSeeds();
+  void processCandidates();
+  void descend(uint64_t Entry);
+
+  /// Error printing
+  raw_ostream &Infos, &Errs;
+  void printInfo(std::string Msg) const {
+    Infos << "FunctionDiscovery: " << Msg << "\n";
+  }
+  void printError(std::string Msg) const {
+    Errs << "FunctionDiscovery: " << Msg << "\n";
+    Errs.flush();
+  }
+};
+
+} // end namespace fracture
+
+#endif /* FUNCTIONDISCOVERY_H */
@@ -70,6 +70,13 @@ public:
 
   void endDAG() { assert(EndHandleDAG && "Reached End of DAG and did not see handle node."); }
 protected:
+  /// Architecture name used when counting unhandled nodes, e.g. "arm".
+  const char* getTargetName() const;
+  /// Called for nodes there is no lowering for. Aborts, unless the
+  /// Decompiler is in coverage mode; then the node is recorded and replaced by
+  /// a call to "fracture.unhandled.<node>.<type>"(address, operands...).
+  Value* visitUnhandled(const SDNode *N);
+
   bool EndHandleDAG;
   Decompiler *Dec;
   SelectionDAG *DAG;
@@ -81,6 +88,44 @@ protected:
   DenseMap<const SDNode*, Value*> VisitMap;
   StringMap<StringRef> BaseNames;
 
+  /// Flags set by a node, kept as the operation that set them. Compares emit
+  /// nothing; a consumer asks for the one condition it tests (see
+  /// getFlagCondition), which is usually a single icmp on the operands.
+  struct LazyFlags {
+    enum FlagOp {
+      Sub,    ///< Flags of LHS - RHS (cmp).
+      Add,    ///< Flags of LHS + RHS (cmn).
+      Logic   ///< Flags of a logic op with result Res; carry and overflow
+              ///< are clear (test, and, or, xor).
+    };
+    FlagOp Op;
+    Value *LHS, *RHS;
+    /// The result of the operation, when it was emitted anyway.
+    Value *Res;
+  };
+  /// Conditions on the flags, named after the compare they stand for: after
+  /// a Sub, FC_ULT is LHS <u RHS; after a Logic op, Res <u 0. After an Add the
+  /// unsigned conditions test the ARM carry, i.e. FC_UGE is a carry out.
+  enum FlagCond {
+    FC_EQ, FC_NE,                     // Z
+    FC_UGE, FC_ULT, FC_UGT, FC_ULE,   // C and Z
+    FC_SGE, FC_SLT, FC_SGT, FC_SLE,   // N, V and Z
+    FC_MI, FC_PL,                     // N
+    FC_VS, FC_VC                      // V
+  };
+  DenseMap<const SDNode*, LazyFlags> FlagsMap;
+
+  /// Records the flags set by N without emitting anything.
+  void recordFlags(const SDNode *N, LazyFlags::FlagOp Op, Value *LHS,
+    Value *RHS, Value *Res = NULL);
+  /// Emits the i1 value of Cond on the flags recorded for FlagsNode, visiting
+  /// it first if needed. Returns NULL if FlagsNode does not set flags.
+  Value* getFlagCondition(const SDNode *FlagsNode, FlagCond Cond);
+  /// Single flags, for the conditions with no direct compare.
+  Value* getFlagsResult(LazyFlags &Flags);
+  Value* getCarryFlag(LazyFlags &Flags);
+  Value* getOverflowFlag(LazyFlags &Flags);
+
   // Visit Functions (Convert SDNode into Instruction/Value)
   virtual Value* visit(const SDNode *N);
   Value* visitCopyFromReg(const SDNode *N);
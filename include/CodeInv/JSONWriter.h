@@ -0,0 +1,32 @@
+//===--- JSONWriter - Helpers for the JSON reports --------------*- C++ -*-===//
+//
+//              Fracture: The Draper Decompiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Shared by the JSON writers of the library (Metrics, CoverageProfile) and of
+// the tools (fracture-batch, fracture-bench), so every report escapes strings
+// the same way.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef JSONWRITER_H
+#define JSONWRITER_H
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/raw_ostream.h"
+
+using namespace llvm;
+
+namespace fracture {
+
+/// \brief Writes Str as a quoted JSON string, escaping quotes, backslashes
+/// and control characters.
+void writeJSONString(raw_ostream &Out, StringRef Str);
+
+} // end namespace fracture
+
+#endif /* JSONWRITER_H */
@@ -22,15 +22,19 @@
 
 #include "llvm/ADT/IndexedMap.h"
 #include "llvm/CodeGen/ValueTypes.h"
+#include "llvm/IR/DataLayout.h"
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/MC/MCAsmInfo.h"
 #include "llvm/MC/MCDisassembler.h"
 #include "llvm/MC/MCContext.h"
 #include "llvm/MC/MCInstPrinter.h"
+#include "llvm/MC/MCInstrAnalysis.h"
+#include "llvm/MC/MCInstrDesc.h"
 #include "llvm/MC/MCInstrInfo.h"
 #include "llvm/MC/MCObjectFileInfo.h"
 #include "llvm/MC/MCRegisterInfo.h"
 #include "llvm/MC/MCSubtargetInfo.h"
+#include "llvm/Target/TargetLowering.h"
 #include "llvm/Target/TargetMachine.h"
 #include "llvm/Target/TargetOptions.h"
 #include "llvm/Target/TargetRegisterInfo.h"
@@ -39,6 +43,8 @@
 #include "llvm/Support/TargetRegistry.h"
 #include "llvm/Support/raw_ostream.h"
 
+#include <vector>
+
 using namespace llvm;
 
 namespace fracture {
@@ -88,8 +94,45 @@ public:
   const MCInstrInfo* getMCInstrInfo() const { return MII; }
   const MCDisassembler* getMCDisassembler() const { return DisAsm; }
   MCInstPrinter* getMCInstPrinter() const { return MIP; }
+  const MCInstrAnalysis* getMCInstrAnalysis() const { return MIA; }
 
-  EVT getRegType(unsigned RegisterID);
+  /// \brief Facts about a single register, computed once at construction.
+  struct RegisterEntry {
+    EVT Type;           ///< Type of the minimal register class.
+    unsigned Width;     ///< Width of the register in bits, 0 if unknown.
+    unsigned SuperReg;  ///< Outermost super-register, or the register itself.
+    bool isPC;          ///< Program counter (or one of its aliases).
+    bool isSP;          ///< Stack pointer (or one of its aliases).
+    bool isFlags;       ///< Condition code register (not copyable).
+    bool isRA;          ///< Return address register (e.g., LR on ARM).
+  };
+
+  /// Register table accessors. All are a single table lookup.
+  unsigned getNumRegs() const { return RegTable.size(); }
+  const RegisterEntry& getRegEntry(unsigned RegisterID) const {
+    return RegTable[RegisterID];
+  }
+  EVT getRegType(unsigned RegisterID) const {
+    return RegTable[RegisterID].Type;
+  }
+  unsigned getRegWidth(unsigned RegisterID) const {
+    return RegTable[RegisterID].Width;
+  }
+  unsigned getSuperReg(unsigned RegisterID) const {
+    return RegTable[RegisterID].SuperReg;
+  }
+  bool isPCReg(unsigned RegisterID) const { return RegTable[RegisterID].isPC; }
+  bool isSPReg(unsigned RegisterID) const { return RegTable[RegisterID].isSP; }
+  bool isFlagsReg(unsigned RegisterID) const {
+    return RegTable[RegisterID].isFlags;
+  }
+  bool isRAReg(unsigned RegisterID) const { return RegTable[RegisterID].isRA; }
+
+  /// \brief Infer the value type of the immediate at operand index OpIdx of
+  /// an instruction with the given descriptor. PC relative operands take the
+  /// pointer width, predicates are always i32, and everything else takes the
+  /// width of the instruction's integer register operands.
+  EVT getImmType(const MCInstrDesc &Desc, unsigned OpIdx);
 
 private:
   LLVMContext *LLVMCtx;
@@ -99,14 +142,18 @@ private:
   TargetMachine *TM;
 
   const MCSubtargetInfo *STI;
-  const MCDisassembler *DisAsm;
   const MCRegisterInfo *MRI;
   MCObjectFileInfo *MCOFI;
   MCContext *MCCtx;
+  const MCDisassembler *DisAsm;
   const MCAsmInfo *AsmInfo;
   const MCInstrInfo *MII;
   MCInstPrinter *MIP;
-  IndexedMap<EVT> RegTypes;
+  const MCInstrAnalysis *MIA;
+  IndexedMap<RegisterEntry> RegTable;
+
+  /// \brief Fill in RegTable from the target register info.
+  void initRegTable();
 
   /// Error printing.
   raw_ostream &Infos, &Errs;
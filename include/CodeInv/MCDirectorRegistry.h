@@ -0,0 +1,66 @@
+//===--- MCDirectorRegistry - Cache of MCDirector objects -------*- C++ -*-===//
+//
+//              Fracture: The Draper Decompiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This class keeps one MCDirector per (triple, CPU, features) so that loading
+// several executables of the same architecture does not rebuild the target
+// machine and MC layer every time. The registry owns the directors it hands
+// out; Disassemblers only borrow them.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef MCDIRECTORREGISTRY_H
+#define MCDIRECTORREGISTRY_H
+
+#include "CodeInv/MCDirector.h"
+
+#include <map>
+#include <string>
+
+using namespace llvm;
+
+namespace fracture {
+
+class MCDirectorRegistry {
+public:
+  MCDirectorRegistry(raw_ostream &InfoOut = nulls(),
+    raw_ostream &ErrOut = nulls()) : Infos(InfoOut), Errs(ErrOut) {}
+  ~MCDirectorRegistry();
+
+  /// \brief Return the director for the given target, creating it on first
+  /// use. The remaining parameters are only used when the director is created,
+  /// see the MCDirector constructor.
+  MCDirector* getDirector(std::string TripleName,
+    StringRef CPUName = "generic",
+    StringRef Features = "",
+    TargetOptions TargetOpts = TargetOptions(),
+    Reloc::Model RM = Reloc::Default,
+    CodeModel::Model CM = CodeModel::Default,
+    CodeGenOpt::Level OL = CodeGenOpt::Default);
+
+  /// \brief Delete the director for a target, if there is one. Any
+  /// Disassembler still using it must be deleted first.
+  void removeDirector(std::string TripleName, StringRef CPUName = "generic",
+    StringRef Features = "");
+
+  unsigned size() const { return Directors.size(); }
+
+private:
+  std::map<std::string, MCDirector*> Directors;
+
+  static std::string getKey(StringRef TripleName, StringRef CPUName,
+    StringRef Features) {
+    return TripleName.str() + "|" + CPUName.str() + "|" + Features.str();
+  }
+
+  raw_ostream &Infos, &Errs;
+};
+
+} // end namespace fracture
+
+#endif /* MCDIRECTORREGISTRY_H */
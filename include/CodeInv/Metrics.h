@@ -0,0 +1,91 @@
+//===--- Metrics - Per stage timers and counters ----------------*- C++ -*-===//
+//
+//              Fracture: The Draper Decompiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Process wide timers and counters for the decompiler stages: decoding, DAG
+// building, inversion, IR emission and optimization, plus the opcodes each
+// target could not handle. Updates are plain adds, so the library keeps them
+// on all the time; tools print them (fracture-cl "stats") or export them as
+// JSON (fracture-batch -stats).
+//
+// NOTE: Not thread safe. fracture-batch runs its jobs in separate processes,
+// each with its own Metrics.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef METRICS_H
+#define METRICS_H
+
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <stdint.h>
+
+using namespace llvm;
+
+namespace fracture {
+
+class Metrics {
+public:
+  enum TimerID { DecodeTimer, DAGBuildTimer, InvertTimer, EmitTimer,
+                 OptTimer, NumTimers };
+  enum CounterID { InstsDecoded, DecodeFailures, DAGNodesCreated,
+                   DAGNodesInverted, MatcherScopesTried, MatcherScopesFailed,
+                   FunctionsEvicted, NumCounters };
+
+  /// \brief The metrics of this process.
+  static Metrics& get();
+
+  void addTime(TimerID T, double Seconds) {
+    Times[T] += Seconds;
+    ++Calls[T];
+  }
+  void count(CounterID C, uint64_t N = 1) { Counters[C] += N; }
+  /// \brief Records an opcode (instruction or DAG node name) that Target
+  /// could not invert or emit.
+  void countUnhandled(StringRef Target, StringRef Opcode);
+
+  double getTime(TimerID T) const { return Times[T]; }
+  uint64_t getCalls(TimerID T) const { return Calls[T]; }
+  uint64_t getCount(CounterID C) const { return Counters[C]; }
+
+  void reset();
+
+  /// \brief Prints a human readable table.
+  void print(raw_ostream &Out) const;
+  /// \brief Writes a single JSON object.
+  void writeJSON(raw_ostream &Out) const;
+
+  static const char* getTimerName(TimerID T);
+  static const char* getCounterName(CounterID C);
+  /// \brief Monotonic wall time in seconds.
+  static double now();
+
+  /// \brief Adds the time from construction to destruction to a timer.
+  class Scope {
+  public:
+    explicit Scope(TimerID T) : Timer(T), Start(now()) {}
+    ~Scope() { Metrics::get().addTime(Timer, now() - Start); }
+  private:
+    TimerID Timer;
+    double Start;
+  };
+
+private:
+  Metrics() { reset(); }
+
+  double Times[NumTimers];
+  uint64_t Calls[NumTimers];
+  uint64_t Counters[NumCounters];
+  /// Target name -> opcode name -> count.
+  StringMap<StringMap<uint64_t> > Unhandled;
+};
+
+} // end namespace fracture
+
+#endif /* METRICS_H */
@@ -0,0 +1,72 @@
+//===--- ModuleWriter - Writes decompiled modules ---------------*- C++ -*-===//
+//
+//              Fracture: The Draper Decompiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Writes decompiled modules as textual IR or bitcode, either whole or one
+// function at a time.
+//
+// A FunctionStreamer set on the Decompiler (see
+// Decompiler::setFunctionStreamer) gets every function as soon as its body is
+// complete. It writes a module holding only that function into its own file
+// in a directory, and the Decompiler then drops the body, so lifting a whole
+// binary does not keep all of its IR in memory. The globals the functions
+// share (the register variables) are declarations in the function files and
+// are defined once in the file written by finish. llvm-link of the directory
+// gives back the whole module.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef MODULEWRITER_H
+#define MODULEWRITER_H
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/Module.h"
+
+#include <string>
+#include <system_error>
+
+using namespace llvm;
+
+namespace fracture {
+
+enum OutputFormat { TextIR, Bitcode };
+
+/// \brief Bitcode for ".bc" files, textual IR for anything else.
+OutputFormat getOutputFormat(StringRef FileName);
+
+/// \brief Writes M to FileName ("-" for stdout).
+std::error_code writeModule(const Module &M, StringRef FileName,
+  OutputFormat Format);
+
+class FunctionStreamer {
+public:
+  FunctionStreamer(StringRef Directory, OutputFormat Format = Bitcode);
+
+  /// \brief Writes a copy of the module of F, in which every other function
+  /// and every global is a declaration, to the next file of the directory.
+  /// F itself is left untouched.
+  std::error_code writeFunction(Function *F);
+  /// \brief Writes the globals of M, with their definitions, to the
+  /// "globals" file of the directory. Call this after the last function.
+  std::error_code finish(const Module &M);
+
+  const std::string& getDirectory() const { return Directory; }
+  unsigned getNumWritten() const { return NumWritten; }
+
+private:
+  std::string Directory;
+  OutputFormat Format;
+  unsigned NumWritten;
+
+  std::string getFileName(StringRef Name) const;
+};
+
+} // end namespace fracture
+
+#endif /* MODULEWRITER_H */
@@ -0,0 +1,72 @@
+//===--- OpcodeHistogram - Instruction frequency counts ---------*- C++ -*-===//
+//
+//              Fracture: The Draper Decompiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Counts how often each opcode is seen. Counting is an increment into an
+// opcode indexed vector; names are only looked up when histograms are merged,
+// printed or saved. The saved format is keyed by opcode name, so histograms
+// from different binaries (and LLVM builds) can be merged.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef OPCODEHISTOGRAM_H
+#define OPCODEHISTOGRAM_H
+
+#include "llvm/ADT/StringMap.h"
+#include "llvm/MC/MCInstrInfo.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <system_error>
+#include <vector>
+
+using namespace llvm;
+
+namespace fracture {
+
+class OpcodeHistogram {
+public:
+  /// \brief A histogram for the opcodes of one target.
+  OpcodeHistogram(const MCInstrInfo *TheMII);
+  /// \brief An empty histogram to merge saved histograms into.
+  OpcodeHistogram() : MII(NULL), Total(0) {}
+
+  void count(unsigned Opcode) {
+    ++Counts[Opcode];
+    ++Total;
+  }
+
+  /// \brief Adds the counts of Other into this histogram.
+  void merge(const OpcodeHistogram &Other);
+
+  uint64_t getTotal() const { return Total; }
+  uint64_t getCount(StringRef Name) const;
+
+  /// \brief Prints one "name<tab>count" line per opcode seen, most frequent
+  /// first.
+  void print(raw_ostream &Out) const;
+
+  /// \brief Saves the histogram in the mergeable binary format.
+  std::error_code write(StringRef FileName) const;
+  /// \brief Adds the counts of a saved histogram into this one.
+  std::error_code read(StringRef FileName);
+
+private:
+  const MCInstrInfo *MII;
+  /// Opcode indexed counts, when MII is set.
+  std::vector<uint64_t> Counts;
+  /// Counts from other targets or saved histograms.
+  StringMap<uint64_t> NamedCounts;
+  uint64_t Total;
+
+  /// Adds every count, by name, into Entries.
+  void getEntries(StringMap<uint64_t> &Entries) const;
+};
+
+} // end namespace fracture
+
+#endif /* OPCODEHISTOGRAM_H */
@@ -0,0 +1,67 @@
+//===--- OptPipeline - Passes run over decompiled functions -----*- C++ -*-===//
+//
+//              Fracture: The Draper Decompiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// A list of function passes the Decompiler runs over every function once it
+// is fully lifted and its callees are named (see
+// Decompiler::setOptPipeline). The list is parsed once, and the pass manager
+// is built once per module and reused for all of its functions.
+//
+// Passes are named as in opt: mem2reg, sroa, instcombine, simplifycfg,
+// early-cse, gvn, dce, adce, and typerecovery for Fracture's TypeRecovery.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef OPTPIPELINE_H
+#define OPTPIPELINE_H
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/Module.h"
+#include "llvm/PassManager.h"
+
+#include <string>
+#include <vector>
+
+using namespace llvm;
+
+namespace fracture {
+
+class OptPipeline {
+public:
+  /// \brief The passes used when none are given.
+  static const char *DefaultPasses;
+
+  OptPipeline() : FPM(NULL), FPMModule(NULL) {}
+  ~OptPipeline();
+
+  /// \brief Sets the passes from a comma separated list. Returns false and
+  /// sets Error if a name is unknown, leaving the pipeline as it was.
+  bool parse(StringRef Passes, std::string &Error);
+
+  bool empty() const { return PassNames.empty(); }
+  const std::vector<std::string>& getPasses() const { return PassNames; }
+
+  /// \brief Runs the passes over F. Returns true if F was changed.
+  bool run(Function &F);
+  /// \brief Drops the pass manager. Call this when the module it was built
+  /// for is deleted.
+  void reset();
+
+private:
+  std::vector<std::string> PassNames;
+  FunctionPassManager *FPM;
+  /// The module FPM was built for.
+  const Module *FPMModule;
+
+  static Pass* createPass(StringRef Name);
+};
+
+} // end namespace fracture
+
+#endif /* OPTPIPELINE_H */
@@ -0,0 +1,68 @@
+//===--- PrologueScanner - Raw byte function start scanner ------*- C++ -*-===//
+//
+//              Fracture: The Draper Decompiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Finds likely function starts in raw section bytes, without decoding, by
+// searching for the target's common prologue encodings (push ebp; mov ebp,
+// esp, endbr64, push {..., lr}, ...). All patterns are searched in a single
+// pass with a Teddy style filter: each pattern is put in one of eight
+// buckets and, per position, nibble tables over the first few bytes give the
+// buckets that could match there. Only those buckets are verified.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef PROLOGUESCANNER_H
+#define PROLOGUESCANNER_H
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+#include "CodeInv/FractureMemoryObject.h"
+
+#include <vector>
+
+using namespace llvm;
+
+namespace fracture {
+
+class PrologueScanner {
+public:
+  PrologueScanner(StringRef TripleName);
+
+  /// \brief True if there are prologue patterns for the target.
+  bool isSupported() const { return !Patterns.empty(); }
+
+  /// \brief Appends the address of every prologue found in Bytes, which are
+  /// loaded at Base, to Starts in increasing order.
+  void scan(ArrayRef<uint8_t> Bytes, uint64_t Base,
+    std::vector<uint64_t> &Starts) const;
+  void scan(FractureMemoryObject &Mem, std::vector<uint64_t> &Starts) const;
+
+private:
+  static const unsigned NumBuckets = 8;
+  static const unsigned MaxFilterLen = 4;
+
+  struct Pattern {
+    SmallVector<uint8_t, 8> Bytes, Mask;
+    unsigned Align;
+  };
+  std::vector<Pattern> Patterns;
+  /// Pattern indices per bucket.
+  std::vector<unsigned> Buckets[NumBuckets];
+  /// Bucket bits per filter byte, indexed by the low and high nibble.
+  uint8_t LoMask[MaxFilterLen][16], HiMask[MaxFilterLen][16];
+  unsigned FilterLen;
+
+  void addPattern(StringRef Bytes, StringRef Mask, unsigned Align);
+  void buildFilter();
+  bool matches(const Pattern &P, const uint8_t *Data, uint64_t Address) const;
+};
+
+} // end namespace fracture
+
+#endif /* PROLOGUESCANNER_H */
@@ -0,0 +1,72 @@
+//===--- RegisterSSA - Puts machine registers into SSA form -----*- C++ -*-===//
+//
+//              Fracture: The Draper Decompiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// The emitters model every machine register as a global variable, so each
+// CopyFromReg becomes a load and each CopyToReg a store. RegisterSSA turns
+// the register accesses of one finished function into SSA values, following
+// Braun et al., "Simple and Efficient Construction of Static Single
+// Assignment Form": reads take the last value written in the block, reads
+// with no write before them get a phi at the top of the block that is filled
+// from the predecessors, and phis that turn out to merge a single value are
+// removed.
+//
+// The globals stay the way registers are passed between functions: their
+// values are stored before every call and return and loaded again after
+// every call, and the stores that would write back an unchanged value are
+// dropped.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef REGISTERSSA_H
+#define REGISTERSSA_H
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/GlobalVariable.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/ValueHandle.h"
+
+#include <utility>
+#include <vector>
+
+using namespace llvm;
+
+namespace fracture {
+
+class RegisterSSA {
+public:
+  /// \brief Rewrites the register loads and stores of F. Returns true if F
+  /// changed. Run it once the CFG of F is final.
+  bool run(Function &F);
+
+private:
+  typedef std::pair<GlobalVariable*, BasicBlock*> RegBlock;
+
+  /// Value of each register at the end of each block that writes it.
+  DenseMap<RegBlock, Value*> EndDefs;
+  /// Value of each register at the top of each block that reads it before
+  /// writing it.
+  DenseMap<RegBlock, Value*> EntryDefs;
+  /// Phis still to be filled from the predecessors.
+  std::vector<std::pair<GlobalVariable*, PHINode*> > Incomplete;
+  std::vector<WeakVH> Phis;
+  std::vector<WeakVH> Loads;
+  std::vector<WeakVH> WriteBacks;
+
+  /// \brief Returns the registers F only loads and stores directly.
+  void getPromotable(Function &F, std::vector<GlobalVariable*> &Regs);
+  Value* getEntryDef(GlobalVariable *Reg, BasicBlock *BB);
+  Value* getEndDef(GlobalVariable *Reg, BasicBlock *BB);
+  void rewriteBlock(BasicBlock *BB, const std::vector<GlobalVariable*> &Regs);
+  Value* tryRemoveTrivialPhi(PHINode *Phi);
+};
+
+} // end namespace fracture
+
+#endif /* REGISTERSSA_H */
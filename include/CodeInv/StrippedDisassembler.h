@@ -23,7 +23,9 @@
 #include "CodeInv/Decompiler.h"
 #include "CodeInv/Disassembler.h"
 #include "CodeInv/FractureSymbol.h"
+#include "CodeInv/FunctionDiscovery.h"
 #include "CodeInv/MCDirector.h"
+#include "CodeInv/PrologueScanner.h"
 #include "CodeInv/StrippedGraph.h"
 #include "llvm/Object/Error.h"
 #include "llvm/Object/ObjectFile.h"
@@ -63,10 +65,19 @@ namespace fracture {
     }
 
     //NodeType opcodeCheck(int opc, MachineBasicBlock::iterator II);
-    uint64_t getHexAddress(MachineBasicBlock::iterator II);
     uint64_t getStrippedSection(std::string section);
     void functionsIterator(uint64_t Address);
     void findStrippedFunctions(uint64_t Address);
+    /// Blocks and edges of the functions findStrippedFunctions found.
+    const CompactCFG &getCFG() const { return CFG; }
+    void printCFG();
+    const FunctionDiscovery::ExtentMap &getFunctionExtents() const {
+      return FunctionExtents;
+    }
+    /// Prologue matches in the raw bytes, and how many of the functions
+    /// findStrippedFunctions found were started from one of them.
+    unsigned getNumPrologues() const { return NumPrologues; }
+    unsigned getNumPrologueFunctions() const { return NumPrologueFunctions; }
     void findStrippedMain();
     void addSymbol(FractureSymbol S);
     std::vector<FractureSymbol> getSymbolVector();
@@ -79,6 +90,10 @@ namespace fracture {
     std::string TripleName;
     std::vector<FractureSymbol> Symbols;
     uint64_t mainAddr = 0;
+    FunctionDiscovery::ExtentMap FunctionExtents;
+    CompactCFG CFG;
+    unsigned NumPrologues = 0;
+    unsigned NumPrologueFunctions = 0;
   };
 }
 
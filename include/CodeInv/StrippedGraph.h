@@ -21,7 +21,10 @@
 
 #include "llvm/Object/ObjectFile.h"
 #include "llvm/Target/TargetInstrInfo.h"
+#include "CodeInv/Disassembler.h"
+#include "CodeInv/StrippedSignatures.h"
 #include <list>
+#include <map>
 #include <vector>
 
 using namespace llvm;
@@ -42,26 +45,41 @@ class StrippedGraph {
     StrippedGraph(Disassembler *D, std::string T) {
       DAS = D;
       Triple = T;
+      PrevNode = NULL;
+      Sigs = new StrippedSignatures(D->getMCDirector(), T);
     }
     ~StrippedGraph() {
       for (auto &it : AllNodes)
         delete it;
+      delete Sigs;
     }
     void addGraphNode(GraphNode *Node);
     void addToList(GraphNode *Node);
     void printGraph();
     std::vector<GraphNode *> getHeadNodes();
     void correctHeadNodes();
+    const StrippedSignatures *getSignatures() const { return Sigs; }
 
   private:
     Disassembler *DAS;
     std::string Triple;
+    StrippedSignatures *Sigs;
     std::vector<GraphNode *> HeadNodes;
-    std::vector<GraphNode *> NeedsLink;
+    // Branches whose target block has not been added yet, by target address.
+    std::multimap<uint64_t, GraphNode *> NeedsLink;
     std::list<GraphNode *> AllNodes;
+    // Blocks and head blocks by start address, for interval lookups.
+    std::map<uint64_t, GraphNode *> NodeIndex;
+    std::map<uint64_t, GraphNode *> HeadIndex;
     GraphNode *PrevNode;
     bool AlreadyASuccessor;
-    void resolveLinks();
+    void addHeadNode(GraphNode *Node);
+    void resolveLinks(GraphNode *Node);
+    GraphNode *findNode(const std::map<uint64_t, GraphNode *> &Index,
+                        uint64_t Address);
+    /// Moves Node from its current address to Address in Index.
+    void rekeyNode(std::map<uint64_t, GraphNode *> &Index, GraphNode *Node,
+                   uint64_t Address);
     void nodeVisit(std::vector<GraphNode *>::iterator NodeIt, GraphNode *ToAdd);
     void printNode(GraphNode *Node);
     void printVisit(GraphNode *Node);
@@ -0,0 +1,117 @@
+//===--- StrippedSignatures - Opcode signatures for stripped code -*- C++ -*-===//
+//
+//              Fracture: The Draper Decompiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Per-target tables of instruction classes (nop padding, function prologues,
+// the crt start sequence) used to find functions and main in stripped
+// binaries. Classes are written as opcode names and resolved against the
+// target's MCInstrInfo once, so they survive LLVM renumbering its opcodes.
+// Multi-instruction signatures are compiled into a single shift-and
+// automaton that is advanced once per decoded instruction.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef STRIPPEDSIGNATURES_H
+#define STRIPPEDSIGNATURES_H
+
+#include "llvm/ADT/BitVector.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/CodeGen/MachineInstr.h"
+#include "llvm/MC/MCInst.h"
+#include "llvm/MC/MCInstrInfo.h"
+#include "CodeInv/MCDirector.h"
+
+#include <vector>
+
+using namespace llvm;
+
+namespace fracture {
+
+class StrippedSignatures {
+public:
+  /// Instruction classes a target table can fill in.
+  enum InstClass {
+    NopPadding,     ///< Filler before a function's first real instruction.
+    FunctionEntry,  ///< The instruction that opens a function prologue.
+    StartEntry,     ///< First marker of the crt start sequence.
+    StartPush,      ///< Argument push in the crt start sequence (ARM).
+    LiteralLoad,    ///< Literal pool load of main's address (ARM).
+    Call,           ///< Direct or indirect call.
+    NumInstClasses,
+    AnyInst,        ///< Signature step: any single instruction.
+    AnyGap          ///< Signature step: one or more instructions.
+  };
+
+  /// Multi-instruction signatures.
+  enum Signature {
+    NoSignature = -1,
+    StartToMain,    ///< From the crt entry marker to the point naming main.
+    NumSignatures
+  };
+
+  StrippedSignatures(const MCDirector *MC, StringRef TripleName);
+
+  /// \brief True if the target has any table entries at all.
+  bool isSupported() const { return Supported; }
+
+  /// \brief Opcode-only membership test. Ignores the operand constraints,
+  /// so e.g. every x86 lea passes for NopPadding.
+  bool isA(InstClass Class, unsigned Opcode) const {
+    return Opcode < Classes[Class].Opcodes.size() &&
+      Classes[Class].Opcodes.test(Opcode);
+  }
+
+  /// \brief Membership test including the operand constraints of the class
+  /// (a required register, a required predicate, or for some opcodes that
+  /// the instruction leaves its only register unchanged).
+  bool isA(InstClass Class, const MachineInstr *MI) const;
+  /// \brief The same test on a decoded MCInst.
+  bool isA(InstClass Class, const MCInst &Inst) const;
+
+  /// \brief Streams decoded opcodes through the signature automaton.
+  class Scanner {
+  public:
+    Scanner(const StrippedSignatures &S) : Sigs(S), State(0) {}
+    /// Advances by one instruction and returns the signature it completes,
+    /// or NoSignature.
+    Signature step(unsigned Opcode);
+    void reset() { State = 0; }
+  private:
+    const StrippedSignatures &Sigs;
+    uint64_t State;
+  };
+
+private:
+  struct ClassInfo {
+    BitVector Opcodes;
+    /// Opcodes that only count as a self move (see SelfMoveCheck).
+    BitVector SelfMoves;
+    SmallVector<unsigned, 2> Regs;
+    int PredImm;
+    ClassInfo() : PredImm(-1) {}
+  };
+
+  const MCInstrInfo *MII;
+  bool Supported;
+  ClassInfo Classes[NumInstClasses];
+
+  // Shift-and state: one bit per signature step, all signatures packed into
+  // one word. StepMasks[Opcode] has the bits of every step Opcode satisfies.
+  std::vector<uint64_t> StepMasks;
+  uint64_t StartBits, GapBits;
+  uint64_t EndBits[NumSignatures];
+
+  void addClass(InstClass Class, StringRef Names, StringRef Regs, int PredImm,
+    bool SelfMove, const MCInstrInfo *MII, const MCRegisterInfo *MRI);
+  void addSignature(Signature Sig, ArrayRef<InstClass> Steps,
+    unsigned &NextBit);
+};
+
+} // end namespace fracture
+
+#endif /* STRIPPEDSIGNATURES_H */
@@ -18,14 +18,22 @@
 #ifndef BASICCALLGRAPH_H_
 #define BASICCALLGRAPH_H_
 
+#include "CodeInv/DecompilerListener.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/Analysis/CallGraph.h"
+#include "llvm/IR/CallSite.h"
 #include "llvm/IR/Module.h"
 #include "llvm/Support/raw_ostream.h"
 
 using namespace llvm;
 
 /// \brief An abstraction for a CFG.
-class BasicCallGraph: public CallGraph {
+///
+/// Edits are applied to the graph as they are made: each update costs time in
+/// the size of what it changes, not in the size of the module. As a
+/// DecompilerListener the graph also grows with the functions a Decompiler
+/// lifts into its module.
+class BasicCallGraph: public CallGraph, public fracture::DecompilerListener {
   // Root is root of the call graph, or the external node if a 'main' function
   // couldn't be found.
   CallGraphNode *Root;
@@ -37,6 +45,10 @@ class BasicCallGraph: public CallGraph {
   // CallsExternalNode - This node has edges to it from all functions making
   // indirect calls or calling an external function.
   CallGraphNode *CallsExternalNode;
+
+  // Callers - Number of edges from each caller to each node, so the edges to
+  // a node can be found without scanning the whole graph.
+  DenseMap<CallGraphNode*, DenseMap<CallGraphNode*, unsigned> > Callers;
 private:
   //===---------------------------------------------------------------------
   // Implementation of CallGraph construction
@@ -47,6 +59,18 @@ private:
   //
   void addToCallGraph(Function *F);
 
+  // getCalleeNode - The node a call at CS is an edge to, or null for calls to
+  // intrinsics, which are not in the graph.
+  CallGraphNode* getCalleeNode(CallSite CS);
+
+  // addEdge / forgetEdge - Add an edge, or note that one is gone, keeping
+  // Callers up to date.
+  void addEdge(CallGraphNode *Caller, CallSite CS, CallGraphNode *Callee);
+  void forgetEdge(CallGraphNode *Caller, CallGraphNode *Callee);
+
+  // removeCallEdges - Remove all the out-edges of Node.
+  void removeCallEdges(CallGraphNode *Node);
+
   //
   // destroy - Release memory for the call graph
   virtual void destroy();
@@ -56,6 +80,24 @@ private:
 public:
   BasicCallGraph(Module &M);
 
+  /// \brief Adds F to the graph, or rescans it if it is already there, and
+  /// returns its node. Call it after changing the body of F.
+  CallGraphNode* addFunction(Function *F);
+  /// \brief Removes F's node and every edge to and from it, and unlinks F
+  /// from the module like removeFunctionFromModule. Returns F.
+  Function* removeFunction(Function *F);
+  /// \brief Adds the edge for the new call at CS.
+  void addCallEdge(CallSite CS);
+  /// \brief Removes the edge for CS. Call it before erasing the call.
+  void removeCallEdge(CallSite CS);
+  /// \brief Moves the edge for CS to the function CS now calls. Call it
+  /// after CS.setCalledFunction.
+  void updateCallEdge(CallSite CS);
+
+  virtual void functionDecompiled(Function *F) {
+    addFunction(F);
+  }
+
   void view();
 
   bool containsFunc(const Function *F);
@@ -21,6 +21,8 @@
 #include "llvm/Linker/Linker.h"
 #include "llvm-c/Linker.h"
 #include "llvm/IR/Verifier.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/Analysis/CallGraph.h"
 #include "llvm/ExecutionEngine/GenericValue.h"
@@ -45,6 +47,10 @@
 
 #include "BasicCallGraph.h"
 
+#include <functional>
+#include <map>
+#include <utility>
+
 using namespace llvm;
 
 /// \brief An abstraction for a CFG editor. This class interacts with .ll files
@@ -52,6 +58,9 @@ using namespace llvm;
 /// modification of said CFG.
 class StructuredModuleEditor {
 
+public:
+  typedef std::function<bool(Function*)> FuncPredicate;
+
 private:
   typedef std::vector<Function*> FuncList;
   typedef std::vector<BasicBlock*> BBList;
@@ -60,10 +69,59 @@ private:
   typedef std::vector<Value*> ValueList;
   typedef std::vector<std::string> StringList;
 
+  /// Functions with the same signature (see signaturesMatch) share a key:
+  /// their function type without varargs and their calling convention.
+  typedef std::pair<FunctionType*, unsigned> SignatureKey;
+
+  /// Instrumentation hooks of one batch, by function type.
+  typedef DenseMap<FunctionType*, Function*> HookMap;
+
   Module *M;
   BasicCallGraph *CG;
   raw_ostream &OS;
 
+  /// Direct, non-intrinsic calls by callee. In module order when built;
+  /// calls and functions added by later edits are appended.
+  DenseMap<Function*, InstList> CallSites;
+  /// Functions by signature, ordered like CallSites.
+  std::map<SignatureKey, FuncList> Signatures;
+  /// getUseChain results. Dropped by every edit.
+  DenseMap<Value*, ValueList> UseChains;
+  /// Hooks and wrappers added by the instrument* and wrapFunc calls.
+  SmallPtrSet<Function*, 16> Instrumentation;
+
+  /// \brief Builds the call site and signature indices for the whole module.
+  /// The scan for call sites is split over threads for large modules.
+  void buildIndices();
+
+  /// \brief Adds F and the calls it makes to the indices.
+  void indexFunction(Function *F);
+
+  /// \brief Removes F, calls to F and the calls F makes from the indices.
+  void unindexFunction(Function *F);
+
+  /// \brief Files the call Call under To instead of From. Call must already
+  /// call To. A NULL From or To only adds or drops the entry.
+  void moveCall(Instruction *Call, Function *From, Function *To);
+
+  SignatureKey getSignatureKey(Function *F);
+
+  /// \brief Appends the functions Pred holds for to Funcs, in module order.
+  void selectFuncs(FuncPredicate Pred, FuncList &Funcs);
+
+  /// \brief Appends the functions that call any of Callees to Callers, once
+  /// each, from the call site index.
+  void planCallers(const FuncList &Callees, FuncList &Callers);
+
+  /// \brief Wraps each of Funcs with a call to a pre and a post hook. Funcs
+  /// with the same argument types share the pre hook, Funcs with the same
+  /// return type the post hook. Variadic Funcs are listed as skipped.
+  void wrapAll(const FuncList &Funcs);
+
+  /// \brief Returns the hook of type Ty in Hooks, declaring a new one named
+  /// Name the first time Ty is asked for.
+  Function* getHook(StringRef Name, FunctionType *Ty, HookMap &Hooks);
+
   bool getCallSite(Function *Func, uint64_t Index, CallSite &CS);
 
   bool signaturesMatch(Function *F1, Function *F2);
@@ -81,7 +139,8 @@ private:
   void dumpInsts(InstList &Insts);
 
   /// \brief Deletes all the instructions pointed to by the specified InstList
-  /// and then clears the InstList
+  /// and then clears the InstList. Deleted calls leave the call site index
+  /// and the call graph.
   ///
   /// Typical usage:
   /// \code
@@ -92,8 +151,8 @@ private:
   ///
   void removeChain(InstList &Chain);
 
-  /// \brief Gathers a list of all call instructions dependending on F's existence
-  /// and returns the list
+  /// \brief Returns the list of all call instructions dependending on F's
+  /// existence, from the call site index
   ///
   /// Typical usage:
   /// \code
@@ -126,6 +185,38 @@ public:
   void instrumentCallsToFunction(StringRef FuncName);
   void instrumentCallsToFunction(Function *Callee);
 
+  /// \brief Batch form of instrumentFunctionsThatCallFunction: wraps every
+  /// function that calls one of Callees once, however many of them it calls.
+  /// All the callers are found before anything is changed, and the pre and
+  /// post hooks are shared by the wrapped functions of the same signature.
+  /// Variadic callers are skipped.
+  void instrumentFunctionsThatCall(const std::vector<Function*> &Callees);
+  /// \brief As above, for every function in the module Pred holds for.
+  void instrumentFunctionsThatCall(FuncPredicate Pred);
+
+  /// \brief Batch form of instrumentCallsToFunction: every one of Callees
+  /// that is called gets one wrapper, which all its calls are redirected to.
+  /// The pre and post hooks are shared by the callees of the same signature.
+  ///
+  /// Variadic callees are skipped. Typical usage, for every external
+  /// function of a lifted binary, leaving out the hooks of earlier batches
+  /// and fracture's "fracture." placeholders for unhandled instructions:
+  /// \code
+  ///   instrumentCallsTo([&Editor](Function *F) {
+  ///     return F->isDeclaration() && !F->isVarArg()
+  ///       && !Editor.isInstrumentation(F)
+  ///       && !F->getName().startswith("fracture.");
+  ///   });
+  /// \endcode
+  void instrumentCallsTo(const std::vector<Function*> &Callees);
+  /// \brief As above, for every function in the module Pred holds for.
+  void instrumentCallsTo(FuncPredicate Pred);
+
+  /// \brief Returns true for the hooks and wrappers this editor added.
+  bool isInstrumentation(Function *F) const {
+    return Instrumentation.count(F);
+  }
+
   // TODO: Comment me
   void linkModule(const std::string &Filename);
 
@@ -31,6 +31,11 @@ public:
     raw_ostream &ErrOut = nulls());
   ~ARMIREmitter();
 private:
+  /// Returns the node that set the CPSR value a consumer reads, or NULL.
+  const SDNode* findFlagsNode(SDValue CPSR) const;
+  /// Emits the i1 value of ARMcc on the flags set by FlagsNode.
+  Value* getARMCondition(const SDNode *FlagsNode, unsigned ARMcc);
+
   virtual Value* visit(const SDNode *N);
   Value* visitWrapper(const SDNode *N);
   Value* visitWrapperPIC(const SDNode *N);
@@ -31,6 +31,11 @@ public:
     raw_ostream &ErrOut = nulls());
   ~X86IREmitter();
 private:
+  /// Returns the node that last set EFLAGS before Chain, or NULL.
+  const SDNode* findEFLAGSProducer(SDValue Chain) const;
+  /// Emits the i1 value of CC on the EFLAGS set by Producer.
+  Value* getEFLAGSCondition(const SDNode *Producer, ISD::CondCode CC);
+
   virtual Value* visit(const SDNode *N);
 
   Value* visitBSF(const SDNode *N);
@@ -55,7 +60,6 @@ private:
   Value* visitFGETSIGNx86(const SDNode *N);
   Value* visitCMOV(const SDNode *N);
   Value* visitBRCOND(const SDNode *N);
-  Value* visitBRCONDAdvanced(const SDNode *N);
   Value* visitRET_FLAG(const SDNode *N);
   Value* visitREP_STOS(const SDNode *N);
   Value* visitREP_MOVS(const SDNode *N);
@@ -0,0 +1,331 @@
+//===--- BatchRunner - Run many jobs in isolated workers --------*- C++ -*-===//
+//
+//              Fracture: The Draper Decompiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Runs a list of jobs on a pool of pre-forked worker processes. The parent
+// hands out job indices over a pipe per worker, and each worker answers with
+// a result record: job index, status, seconds, a message and the job's data.
+//
+//===----------------------------------------------------------------------===//
+
+#include "CodeInv/BatchRunner.h"
+#include "llvm/Support/ErrorHandling.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cerrno>
+#include <cstring>
+#include <poll.h>
+#include <signal.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace llvm;
+
+namespace fracture {
+
+static double now() {
+  using namespace std::chrono;
+  return duration<double>(steady_clock::now().time_since_epoch()).count();
+}
+
+static bool writeAll(int FD, const void *Buf, size_t Size) {
+  const char *Ptr = (const char*)Buf;
+  while (Size != 0) {
+    ssize_t N = ::write(FD, Ptr, Size);
+    if (N < 0 && errno == EINTR)
+      continue;
+    if (N <= 0)
+      return false;
+    Ptr += N;
+    Size -= N;
+  }
+  return true;
+}
+
+static bool readAll(int FD, void *Buf, size_t Size) {
+  char *Ptr = (char*)Buf;
+  while (Size != 0) {
+    ssize_t N = ::read(FD, Ptr, Size);
+    if (N < 0 && errno == EINTR)
+      continue;
+    if (N <= 0)
+      return false;
+    Ptr += N;
+    Size -= N;
+  }
+  return true;
+}
+
+static bool writeResult(int FD, uint32_t Job, BatchRunner::Status S,
+  double Seconds, const std::string &Msg, const std::string &Data) {
+  uint32_t Header[4] = { Job, (uint32_t)S, (uint32_t)Msg.size(),
+    (uint32_t)Data.size() };
+  return writeAll(FD, Header, sizeof(Header))
+    && writeAll(FD, &Seconds, sizeof(Seconds))
+    && writeAll(FD, Msg.data(), Msg.size())
+    && writeAll(FD, Data.data(), Data.size());
+}
+
+// R is only updated once the whole record was read, so a worker dying half
+// way through writing it does not leave a partial result behind.
+static bool readResult(int FD, BatchRunner::Result &R) {
+  uint32_t Header[4];
+  double Seconds;
+  if (!readAll(FD, Header, sizeof(Header))
+    || !readAll(FD, &Seconds, sizeof(Seconds)))
+    return false;
+  std::string Msg(Header[2], '\0'), Data(Header[3], '\0');
+  if ((Header[2] != 0 && !readAll(FD, &Msg[0], Header[2]))
+    || (Header[3] != 0 && !readAll(FD, &Data[0], Header[3])))
+    return false;
+  R.JobStatus = (BatchRunner::Status)Header[1];
+  R.Seconds = Seconds;
+  R.Message.swap(Msg);
+  R.Data.swap(Data);
+  return true;
+}
+
+// Worker side state, for reporting report_fatal_error before exiting.
+static int WorkerOut = -1;
+static uint32_t WorkerJob = 0;
+static double WorkerStart = 0;
+static const BatchRunner::FatalDataFn *WorkerFatalData = NULL;
+
+static void workerFatalError(void *UserData, const std::string &Reason,
+  bool GenCrashDiag) {
+  // Whatever the job counted before the error (e.g., the opcode that could
+  // not be handled) would otherwise be lost with the worker.
+  std::string Data;
+  if (WorkerFatalData && *WorkerFatalData)
+    (*WorkerFatalData)(Data);
+  writeResult(WorkerOut, WorkerJob, BatchRunner::FatalError,
+    now() - WorkerStart, "LLVM ERROR: " + Reason, Data);
+  _exit(1);
+}
+
+BatchRunner::BatchRunner(unsigned Workers, unsigned TimeoutSeconds,
+  raw_ostream &ErrOut) : NumWorkers(Workers), Timeout(TimeoutSeconds),
+  Errs(ErrOut) {}
+
+const char *BatchRunner::getStatusName(Status S) {
+  switch (S) {
+    case Success: return "success";
+    case Failed: return "failed";
+    case FatalError: return "fatal";
+    case Crashed: return "crashed";
+    case TimedOut: return "timeout";
+  }
+  return "unknown";
+}
+
+void BatchRunner::runWorker(int In, int Out, JobFn &Job) {
+  WorkerOut = Out;
+  WorkerFatalData = &FatalData;
+  install_fatal_error_handler(workerFatalError);
+
+  uint32_t Index;
+  while (readAll(In, &Index, sizeof(Index))) {
+    WorkerJob = Index;
+    WorkerStart = now();
+    // SIGALRM is left at its default action, so a stuck job kills the
+    // worker and the parent reports the timeout.
+    if (Timeout != 0)
+      alarm(Timeout);
+    std::string Msg, Data;
+    bool OK = Job(Index, Msg, Data);
+    alarm(0);
+    outs().flush();
+    errs().flush();
+    if (!writeResult(Out, Index, OK ? Success : Failed, now() - WorkerStart,
+          Msg, Data))
+      break;
+  }
+  _exit(0);
+}
+
+bool BatchRunner::spawn(Worker &W, JobFn &Job) {
+  int ToFDs[2], FromFDs[2];
+  if (pipe(ToFDs) != 0) {
+    printError(std::string("pipe failed: ") + strerror(errno));
+    return false;
+  }
+  if (pipe(FromFDs) != 0) {
+    printError(std::string("pipe failed: ") + strerror(errno));
+    close(ToFDs[0]);
+    close(ToFDs[1]);
+    return false;
+  }
+
+  // Buffered output would otherwise be written by both processes.
+  outs().flush();
+  errs().flush();
+  pid_t Pid = fork();
+  if (Pid < 0) {
+    printError(std::string("fork failed: ") + strerror(errno));
+    close(ToFDs[0]);
+    close(ToFDs[1]);
+    close(FromFDs[0]);
+    close(FromFDs[1]);
+    return false;
+  }
+  if (Pid == 0) {
+    // Other workers only see end of file on their job pipe once every copy
+    // of its write end is closed, including the ones inherited here.
+    for (unsigned i = 0, e = Workers.size(); i != e; ++i)
+      if (&Workers[i] != &W && Workers[i].Pid > 0) {
+        close(Workers[i].ToWorker);
+        close(Workers[i].FromWorker);
+      }
+    close(ToFDs[1]);
+    close(FromFDs[0]);
+    runWorker(ToFDs[0], FromFDs[1], Job);
+  }
+
+  close(ToFDs[0]);
+  close(FromFDs[1]);
+  W.Pid = Pid;
+  W.ToWorker = ToFDs[1];
+  W.FromWorker = FromFDs[0];
+  W.Job = -1;
+  W.Start = 0;
+  return true;
+}
+
+void BatchRunner::reap(Worker &W, Result &R) {
+  close(W.ToWorker);
+  close(W.FromWorker);
+  int WaitStatus = 0;
+  while (waitpid(W.Pid, &WaitStatus, 0) < 0 && errno == EINTR)
+    ;
+  W.Pid = -1;
+  W.Job = -1;
+
+  // R.Data is left as is: it holds what the job returned, if anything.
+  R.Seconds = now() - W.Start;
+  if (WIFSIGNALED(WaitStatus) && WTERMSIG(WaitStatus) == SIGALRM) {
+    R.JobStatus = TimedOut;
+    R.Message = "timed out";
+  } else if (WIFSIGNALED(WaitStatus)) {
+    R.JobStatus = Crashed;
+    R.Message = std::string("killed by signal: ")
+      + strsignal(WTERMSIG(WaitStatus));
+  } else {
+    R.JobStatus = Crashed;
+    R.Message = "worker exited with status "
+      + std::to_string(WEXITSTATUS(WaitStatus));
+  }
+}
+
+void BatchRunner::run(unsigned NumJobs, JobFn Job,
+  std::vector<Result> &Results) {
+  Result NotRun = { Failed, "not run", "", 0 };
+  Results.assign(NumJobs, NotRun);
+
+  if (NumWorkers == 0) {
+    for (unsigned i = 0; i != NumJobs; ++i) {
+      double Start = now();
+      Results[i].JobStatus = Job(i, Results[i].Message, Results[i].Data)
+        ? Success : Failed;
+      Results[i].Seconds = now() - Start;
+    }
+    return;
+  }
+
+  // A worker can die between jobs; its pipe then fails instead of raising
+  // SIGPIPE here.
+  void (*OldPipeHandler)(int) = signal(SIGPIPE, SIG_IGN);
+
+  Worker Idle = { -1, -1, -1, -1, 0 };
+  Workers.assign(std::min(NumWorkers, NumJobs), Idle);
+  for (unsigned i = 0, e = Workers.size(); i != e; ++i)
+    if (!spawn(Workers[i], Job)) {
+      Workers.resize(i);
+      break;
+    }
+
+  unsigned Next = 0, Done = 0;
+  std::vector<pollfd> FDs;
+  std::vector<unsigned> FDWorkers;
+  while (Done < NumJobs && !Workers.empty()) {
+    for (unsigned i = 0, e = Workers.size(); i != e; ++i) {
+      Worker &W = Workers[i];
+      if (W.Pid <= 0 || W.Job != -1 || Next == NumJobs)
+        continue;
+      uint32_t Index = Next;
+      if (!writeAll(W.ToWorker, &Index, sizeof(Index))) {
+        Result Ignored;
+        reap(W, Ignored);
+        spawn(W, Job);
+        continue;
+      }
+      W.Job = Next++;
+      W.Start = now();
+    }
+
+    FDs.clear();
+    FDWorkers.clear();
+    for (unsigned i = 0, e = Workers.size(); i != e; ++i)
+      if (Workers[i].Pid > 0 && Workers[i].Job != -1) {
+        pollfd PFD = { Workers[i].FromWorker, POLLIN, 0 };
+        FDs.push_back(PFD);
+        FDWorkers.push_back(i);
+      }
+    if (FDs.empty()) {
+      // Every worker failed to respawn.
+      bool Alive = false;
+      for (unsigned i = 0, e = Workers.size(); i != e; ++i)
+        Alive |= Workers[i].Pid > 0;
+      if (!Alive)
+        break;
+      continue;
+    }
+    if (poll(&FDs[0], FDs.size(), -1) < 0) {
+      if (errno == EINTR)
+        continue;
+      printError(std::string("poll failed: ") + strerror(errno));
+      break;
+    }
+
+    for (unsigned i = 0, e = FDs.size(); i != e; ++i) {
+      if (FDs[i].revents == 0)
+        continue;
+      Worker &W = Workers[FDWorkers[i]];
+      Result &R = Results[W.Job];
+      ++Done;
+      if (readResult(W.FromWorker, R)) {
+        W.Job = -1;
+        // The worker reported a fatal error and is exiting.
+        if (R.JobStatus == FatalError) {
+          Result Ignored;
+          reap(W, Ignored);
+          spawn(W, Job);
+        }
+        continue;
+      }
+      reap(W, R);
+      spawn(W, Job);
+    }
+  }
+
+  // Closing the job pipe ends each worker's loop.
+  for (unsigned i = 0, e = Workers.size(); i != e; ++i) {
+    if (Workers[i].Pid <= 0)
+      continue;
+    close(Workers[i].ToWorker);
+    close(Workers[i].FromWorker);
+    while (waitpid(Workers[i].Pid, NULL, 0) < 0 && errno == EINTR)
+      ;
+  }
+  Workers.clear();
+  signal(SIGPIPE, OldPipeHandler);
+}
+
+} // end namespace fracture
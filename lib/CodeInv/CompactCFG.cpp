@@ -0,0 +1,215 @@
+//===--- CompactCFG - Compressed sparse row control flow graph --*- C++ -*-===//
+//
+//              Fracture: The Draper Decompiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This class holds a control flow graph over address ranges in compressed
+// sparse row form, see CompactCFG.h.
+//
+//===----------------------------------------------------------------------===//
+
+#include "CodeInv/CompactCFG.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace fracture {
+
+void CompactCFG::addBlock(uint64_t Start, uint64_t End) {
+  assert(!Finalized && "Cannot add blocks to a finalized graph!");
+  Starts.push_back(Start);
+  Ends.push_back(End);
+}
+
+void CompactCFG::addEdge(uint64_t From, uint64_t To) {
+  assert(!Finalized && "Cannot add edges to a finalized graph!");
+  PendingEdges.push_back(std::make_pair(From, To));
+}
+
+void CompactCFG::finalize() {
+  // Sort the blocks by start address.
+  std::vector<std::pair<uint64_t, uint64_t> > Blocks(Starts.size());
+  for (unsigned i = 0, e = Starts.size(); i != e; ++i) {
+    Blocks[i] = std::make_pair(Starts[i], Ends[i]);
+  }
+  std::sort(Blocks.begin(), Blocks.end());
+  for (unsigned i = 0, e = Blocks.size(); i != e; ++i) {
+    Starts[i] = Blocks[i].first;
+    Ends[i] = Blocks[i].second;
+  }
+  std::vector<std::pair<uint64_t, uint64_t> >().swap(Blocks);
+
+  // Resolve edge addresses to blocks, dropping duplicates and edges that
+  // leave the graph.
+  std::vector<std::pair<NodeID, NodeID> > Edges;
+  Edges.reserve(PendingEdges.size());
+  for (unsigned i = 0, e = PendingEdges.size(); i != e; ++i) {
+    NodeID From = findBlock(PendingEdges[i].first);
+    NodeID To = findBlock(PendingEdges[i].second);
+    if (From != InvalidNode && To != InvalidNode) {
+      Edges.push_back(std::make_pair(From, To));
+    }
+  }
+  std::vector<std::pair<uint64_t, uint64_t> >().swap(PendingEdges);
+  std::sort(Edges.begin(), Edges.end());
+  Edges.erase(std::unique(Edges.begin(), Edges.end()), Edges.end());
+
+  // Counting sort the edges into the successor and predecessor arrays.
+  unsigned NumNodes = Starts.size();
+  SuccOffsets.assign(NumNodes + 1, 0);
+  PredOffsets.assign(NumNodes + 1, 0);
+  for (unsigned i = 0, e = Edges.size(); i != e; ++i) {
+    ++SuccOffsets[Edges[i].first + 1];
+    ++PredOffsets[Edges[i].second + 1];
+  }
+  for (unsigned i = 0; i != NumNodes; ++i) {
+    SuccOffsets[i + 1] += SuccOffsets[i];
+    PredOffsets[i + 1] += PredOffsets[i];
+  }
+  Succs.resize(Edges.size());
+  Preds.resize(Edges.size());
+  std::vector<uint32_t> SuccFill(SuccOffsets.begin(), SuccOffsets.end() - 1);
+  std::vector<uint32_t> PredFill(PredOffsets.begin(), PredOffsets.end() - 1);
+  for (unsigned i = 0, e = Edges.size(); i != e; ++i) {
+    Succs[SuccFill[Edges[i].first]++] = Edges[i].second;
+    Preds[PredFill[Edges[i].second]++] = Edges[i].first;
+  }
+
+  Finalized = true;
+}
+
+CompactCFG::NodeID CompactCFG::findBlock(uint64_t Address) const {
+  std::vector<uint64_t>::const_iterator It =
+    std::upper_bound(Starts.begin(), Starts.end(), Address);
+  if (It == Starts.begin()) {
+    return InvalidNode;
+  }
+  NodeID N = (It - Starts.begin()) - 1;
+  if (Address >= Ends[N]) {
+    return InvalidNode;
+  }
+  return N;
+}
+
+void CompactCFG::depthFirst(NodeID Entry, std::vector<NodeID> &Order) const {
+  Order.clear();
+  std::vector<bool> Visited(size(), false);
+  std::vector<NodeID> Stack;
+  Stack.push_back(Entry);
+  while (!Stack.empty()) {
+    NodeID N = Stack.back();
+    Stack.pop_back();
+    if (Visited[N]) {
+      continue;
+    }
+    Visited[N] = true;
+    Order.push_back(N);
+    // Push in reverse so the first successor is visited first.
+    ArrayRef<NodeID> S = successors(N);
+    for (unsigned i = S.size(); i != 0; --i) {
+      if (!Visited[S[i - 1]]) {
+        Stack.push_back(S[i - 1]);
+      }
+    }
+  }
+}
+
+void CompactCFG::postOrder(NodeID Entry, std::vector<NodeID> &Order) const {
+  Order.clear();
+  std::vector<bool> Visited(size(), false);
+  // Each stack entry is a block and the index of its next successor.
+  std::vector<std::pair<NodeID, unsigned> > Stack;
+  Visited[Entry] = true;
+  Stack.push_back(std::make_pair(Entry, 0U));
+  while (!Stack.empty()) {
+    NodeID N = Stack.back().first;
+    ArrayRef<NodeID> S = successors(N);
+    if (Stack.back().second == S.size()) {
+      Order.push_back(N);
+      Stack.pop_back();
+      continue;
+    }
+    NodeID Succ = S[Stack.back().second++];
+    if (!Visited[Succ]) {
+      Visited[Succ] = true;
+      Stack.push_back(std::make_pair(Succ, 0U));
+    }
+  }
+}
+
+void CompactCFG::reversePostOrder(NodeID Entry,
+  std::vector<NodeID> &Order) const {
+  postOrder(Entry, Order);
+  std::reverse(Order.begin(), Order.end());
+}
+
+void CompactCFG::computeDominators(NodeID Entry,
+  std::vector<NodeID> &IDom) const {
+  // Cooper, Harvey and Kennedy, "A Simple, Fast Dominance Algorithm".
+  std::vector<NodeID> PO;
+  postOrder(Entry, PO);
+  std::vector<unsigned> PONum(size(), ~0U);
+  for (unsigned i = 0, e = PO.size(); i != e; ++i) {
+    PONum[PO[i]] = i;
+  }
+
+  IDom.assign(size(), InvalidNode);
+  IDom[Entry] = Entry;
+  bool Changed = true;
+  while (Changed) {
+    Changed = false;
+    // Reverse postorder, skipping the entry.
+    for (unsigned i = PO.size() - 1; i != 0; --i) {
+      NodeID N = PO[i - 1];
+      NodeID NewIDom = InvalidNode;
+      ArrayRef<NodeID> P = predecessors(N);
+      for (unsigned j = 0, e = P.size(); j != e; ++j) {
+        NodeID Pred = P[j];
+        if (IDom[Pred] == InvalidNode) {
+          continue;
+        }
+        if (NewIDom == InvalidNode) {
+          NewIDom = Pred;
+          continue;
+        }
+        // Intersect
+        NodeID A = Pred, B = NewIDom;
+        while (A != B) {
+          while (PONum[A] < PONum[B]) {
+            A = IDom[A];
+          }
+          while (PONum[B] < PONum[A]) {
+            B = IDom[B];
+          }
+        }
+        NewIDom = A;
+      }
+      if (IDom[N] != NewIDom) {
+        IDom[N] = NewIDom;
+        Changed = true;
+      }
+    }
+  }
+}
+
+bool CompactCFG::dominates(const std::vector<NodeID> &IDom, NodeID A,
+  NodeID B) {
+  if (IDom[B] == InvalidNode) {
+    return false;
+  }
+  while (B != A) {
+    NodeID Up = IDom[B];
+    if (Up == B) {
+      // Reached the entry.
+      return false;
+    }
+    B = Up;
+  }
+  return true;
+}
+
+} // end namespace fracture
@@ -0,0 +1,143 @@
+//===--- CoverageProfile - Unhandled node profile ---------------*- C++ -*-===//
+//
+//              Fracture: The Draper Decompiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Records the nodes the emitters could not lower, ranked by frequency.
+//
+//===----------------------------------------------------------------------===//
+
+#include "CodeInv/CoverageProfile.h"
+#include "CodeInv/JSONWriter.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/Format.h"
+
+#include <algorithm>
+
+using namespace llvm;
+
+namespace fracture {
+
+void CoverageProfile::record(StringRef Target, StringRef Opcode,
+  StringRef Node, uint64_t Address) {
+  add(Target, Opcode, Node, 1, Address);
+}
+
+void CoverageProfile::add(StringRef Target, StringRef Opcode, StringRef Node,
+  uint64_t Count, ArrayRef<uint64_t> Addresses) {
+  std::string Key = Target.str();
+  Key += '\0';
+  Key += Opcode;
+  Key += '\0';
+  Key += Node;
+
+  StringMap<Entry>::iterator It = Entries.find(Key);
+  if (It == Entries.end()) {
+    Entry NewEntry;
+    NewEntry.Target = Target;
+    NewEntry.Opcode = Opcode;
+    NewEntry.Node = Node;
+    NewEntry.Count = 0;
+    It = Entries.insert(std::make_pair(Key, NewEntry)).first;
+  }
+  Entry &E = It->getValue();
+  E.Count += Count;
+  Total += Count;
+  for (unsigned i = 0, e = Addresses.size(); i != e; ++i)
+    if (E.Addresses.size() < MaxAddresses
+      && std::find(E.Addresses.begin(), E.Addresses.end(), Addresses[i])
+        == E.Addresses.end())
+      E.Addresses.push_back(Addresses[i]);
+}
+
+void CoverageProfile::clear() {
+  Entries.clear();
+  Total = 0;
+}
+
+static bool compareEntries(const CoverageProfile::Entry *A,
+  const CoverageProfile::Entry *B) {
+  if (A->Count != B->Count)
+    return A->Count > B->Count;
+  if (A->Target != B->Target)
+    return A->Target < B->Target;
+  if (A->Opcode != B->Opcode)
+    return A->Opcode < B->Opcode;
+  return A->Node < B->Node;
+}
+
+void CoverageProfile::getRanked(std::vector<const Entry*> &Ranked) const {
+  Ranked.clear();
+  for (StringMap<Entry>::const_iterator I = Entries.begin(),
+         E = Entries.end(); I != E; ++I)
+    Ranked.push_back(&I->getValue());
+  std::sort(Ranked.begin(), Ranked.end(), compareEntries);
+}
+
+void CoverageProfile::print(raw_ostream &Out) const {
+  std::vector<const Entry*> Ranked;
+  getRanked(Ranked);
+  for (unsigned i = 0, e = Ranked.size(); i != e; ++i) {
+    const Entry *E = Ranked[i];
+    Out << E->Count << "\t" << E->Target << "\t"
+        << (E->Opcode.empty() ? "?" : E->Opcode) << "\t" << E->Node << "\t";
+    for (unsigned a = 0, ae = E->Addresses.size(); a != ae; ++a)
+      Out << (a ? "," : "") << format("0x%llx",
+        (unsigned long long)E->Addresses[a]);
+    Out << "\n";
+  }
+}
+
+bool CoverageProfile::read(StringRef Text) {
+  SmallVector<StringRef, 64> Lines;
+  Text.split(Lines, "\n");
+  for (unsigned i = 0, e = Lines.size(); i != e; ++i) {
+    if (Lines[i].empty())
+      continue;
+    SmallVector<StringRef, 5> Fields;
+    Lines[i].split(Fields, "\t");
+    uint64_t Count;
+    if (Fields.size() != 5 || Fields[0].getAsInteger(10, Count))
+      return false;
+    SmallVector<StringRef, 8> AddrStrs;
+    SmallVector<uint64_t, 8> Addresses;
+    Fields[4].split(AddrStrs, ",");
+    for (unsigned a = 0, ae = AddrStrs.size(); a != ae; ++a) {
+      uint64_t Address;
+      if (AddrStrs[a].empty())
+        continue;
+      if (AddrStrs[a].getAsInteger(0, Address))
+        return false;
+      Addresses.push_back(Address);
+    }
+    add(Fields[1], Fields[2] == "?" ? StringRef() : Fields[2], Fields[3],
+      Count, Addresses);
+  }
+  return true;
+}
+
+void CoverageProfile::writeJSON(raw_ostream &Out) const {
+  std::vector<const Entry*> Ranked;
+  getRanked(Ranked);
+  Out << "[";
+  for (unsigned i = 0, e = Ranked.size(); i != e; ++i) {
+    const Entry *E = Ranked[i];
+    Out << (i ? ", " : " ") << "{ \"target\": ";
+    writeJSONString(Out, E->Target);
+    Out << ", \"opcode\": ";
+    writeJSONString(Out, E->Opcode);
+    Out << ", \"node\": ";
+    writeJSONString(Out, E->Node);
+    Out << ", \"count\": " << E->Count << ", \"addresses\": [";
+    for (unsigned a = 0, ae = E->Addresses.size(); a != ae; ++a)
+      Out << (a ? ", " : " ") << E->Addresses[a];
+    Out << " ] }";
+  }
+  Out << " ]";
+}
+
+} // end namespace fracture
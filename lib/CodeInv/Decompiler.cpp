@@ -16,6 +16,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "CodeInv/Decompiler.h"
+#include "CodeInv/Metrics.h"
 
 using namespace llvm;
 
@@ -24,13 +25,11 @@ using namespace llvm;
 namespace fracture {
 
 Decompiler::Decompiler(Disassembler *NewDis, Module *NewMod, raw_ostream &InfoOut, raw_ostream &ErrOut) :
-    Dis(NewDis), Mod(NewMod), DAG(NULL), ViewMCDAGs(false), ViewIRDAGs(false), Infos(InfoOut), Errs(ErrOut){
+    Dis(NewDis), Mod(NewMod), DAG(NULL), ViewMCDAGs(false), ViewIRDAGs(false), Coverage(NULL), Streamer(NULL), Optimizer(NULL), Listener(NULL), UseRegisterSSA(false), Infos(InfoOut), Errs(ErrOut){
 
   assert(NewDis && "Cannot initialize decompiler with null Disassembler!");
   if (Mod == NULL) {
-    std::string ModID = Dis->getExecutable()->getFileName().data();
-    ModID += "-IR";
-    Mod = new Module(StringRef(ModID), *(Dis->getMCDirector()->getContext()));
+    Mod = createModule();
   }
   Context = Dis->getMCDirector()->getContext();
 
@@ -43,62 +42,173 @@ Decompiler::~Decompiler() {
   delete Emitter;
   delete DAG;
   delete InvISel;
-  delete Context;
+  // NOTE: Context belongs to the MCDirector.
   delete Mod;
   delete Dis;
 }
 
+Module* Decompiler::createModule() {
+  std::string ModID = Dis->getExecutable()->getFileName().data();
+  ModID += "-IR";
+  return new Module(StringRef(ModID), *(Dis->getMCDirector()->getContext()));
+}
+
+void Decompiler::reset() {
+  // The emitter caches register globals from the old module.
+  delete Emitter;
+  delete Mod;
+  Mod = createModule();
+  Streamed.clear();
+  FailedAddrs.clear();
+  if (Optimizer != NULL) {
+    Optimizer->reset();
+  }
+  Emitter = InvISel->getEmitter(this, Infos, Errs);
+}
+
 void Decompiler::decompile(unsigned Address) {
   std::vector<unsigned> Children;
   Children.push_back(Address);
 
   do {
-    //size_t ChildrenSize = Children.size();
-    //errs() << "Size: " << ChildrenSize << "\n";
     Function* CurFunc = decompileFunction(Children.back());
     Children.pop_back();
     if (CurFunc == NULL) {
       continue;
     }
-    // Scan Current Function for children (should probably record children
-    // during decompile...)
-    for (Function::iterator BI = CurFunc->begin(), BE = CurFunc->end();
-         BI != BE; ++BI) {
-      for (BasicBlock::iterator I = BI->begin(), E = BI->end();
-           I != E; ++I) {
-        CallInst *CI = dyn_cast<CallInst>(I);
-        //outs() << "------CI------\n";
-        if (CI == NULL || !CI->getCalledFunction()->hasFnAttribute("Address")) {
-          //outs() << "Continue?\n";
-          continue;
-        }
-        //CI->dump();
-        StringRef AddrStr =
-          CI->getCalledFunction()->getFnAttribute("Address").getValueAsString();
-        uint64_t Addr;
-        AddrStr.getAsInteger(10, Addr);
-        DEBUG(outs() << "Read Address as: " << format("%1" PRIx64, Addr)
-          << ", " << AddrStr << "\n");
-        StringRef FName = Dis->getFunctionName(Addr);
-        // Change sections to check if function address is paired with a 
-        // relocated function and then set function name accordingly
-        StringRef SectionName;
-        object::SectionRef Section = Dis->getSectionByAddress(Addr);
-        Dis->setSection(Section);
-        Dis->getRelocFunctionName(Addr, FName);
-        Section = Dis->getSectionByAddress(Address);
-        Dis->setSection(Section);
-        CI->getCalledFunction()->setName(FName);
-        Function *NF = Mod->getFunction(FName);
-        if (Addr != 0 && (NF == NULL || NF->empty())) {
-          Children.push_back(Addr);
-        }
+    resolveCallees(CurFunc, Address, &Children);
+    finishFunction(CurFunc);
+  } while (Children.size() != 0); // While there are children, decompile
+}
+
+Function* Decompiler::decompileLazy(unsigned Address) {
+  Function *F = decompileFunction(Address);
+  if (F != NULL) {
+    resolveCallees(F, Address, NULL);
+    finishFunction(F);
+  }
+  return F;
+}
+
+bool Decompiler::isMaterializable(const Function *F) const {
+  return F != NULL && F->isDeclaration() && F->hasFnAttribute("Address")
+    && !isStreamed(F) && !FailedAddrs.count(getFunctionAddress(F));
+}
+
+Function* Decompiler::materialize(Function *F) {
+  if (!isMaterializable(F)) {
+    return F;
+  }
+  uint64_t Addr = getFunctionAddress(F);
+  if (Addr == 0) {
+    return F;
+  }
+  // Decompile into F itself: resolveCallees may have renamed it after a
+  // relocation, which is not the name of the machine function.
+  if (decompileFunction(Addr, F) == NULL || F->isDeclaration()) {
+    FailedAddrs.insert(Addr);
+    return F;
+  }
+  resolveCallees(F, Addr, NULL);
+  finishFunction(F);
+  return F;
+}
+
+void Decompiler::materializeAll() {
+  bool Changed = true;
+  while (Changed) {
+    Changed = false;
+    for (Module::iterator FI = Mod->begin(), FE = Mod->end(); FI != FE; ++FI) {
+      if (!isMaterializable(FI)) {
+        continue;
       }
+      // Library calls and the like stay declarations, and are not tried
+      // again.
+      materialize(FI);
+      Changed |= !FI->isDeclaration() || isStreamed(FI);
     }
-  } while (Children.size() != 0); // While there are children, decompile
+  }
+}
+
+uint64_t Decompiler::getFunctionAddress(const Function *F) const {
+  if (F == NULL || !F->hasFnAttribute("Address")) {
+    return 0;
+  }
+  StringRef AddrStr = F->getFnAttribute("Address").getValueAsString();
+  uint64_t Addr;
+  if (AddrStr.getAsInteger(10, Addr)) {
+    return 0;
+  }
+  return Addr;
+}
+
+void Decompiler::resolveCallees(Function *F, unsigned Address,
+  std::vector<unsigned> *Children) {
+  // Scan Current Function for children (should probably record children
+  // during decompile...)
+  for (Function::iterator BI = F->begin(), BE = F->end(); BI != BE; ++BI) {
+    for (BasicBlock::iterator I = BI->begin(), E = BI->end(); I != E; ++I) {
+      CallInst *CI = dyn_cast<CallInst>(I);
+      if (CI == NULL || !CI->getCalledFunction()->hasFnAttribute("Address")) {
+        continue;
+      }
+      uint64_t Addr = getFunctionAddress(CI->getCalledFunction());
+      DEBUG(outs() << "Read Address as: " << format("%1" PRIx64, Addr)
+        << "\n");
+      StringRef FName = Dis->getFunctionName(Addr);
+      // Change sections to check if function address is paired with a
+      // relocated function and then set function name accordingly
+      object::SectionRef Section = Dis->getSectionByAddress(Addr);
+      Dis->setSection(Section);
+      Dis->getRelocFunctionName(Addr, FName);
+      Section = Dis->getSectionByAddress(Address);
+      Dis->setSection(Section);
+      CI->getCalledFunction()->setName(FName);
+      Function *NF = Mod->getFunction(FName);
+      if (Children != NULL && Addr != 0 && (NF == NULL || NF->empty())) {
+        Children->push_back(Addr);
+      }
+    }
+  }
+}
+
+void Decompiler::setFunctionStreamer(FunctionStreamer *NewStreamer) {
+  Streamer = NewStreamer;
+  if (Streamer == NULL) {
+    return;
+  }
+  // Every file holds a single body, so write out the ones we already have.
+  for (Module::iterator FI = Mod->begin(), FE = Mod->end(); FI != FE; ++FI) {
+    streamFunction(FI);
+  }
 }
 
-Function* Decompiler::decompileFunction(unsigned Address) {
+void Decompiler::finishFunction(Function *F) {
+  if (Optimizer != NULL && !F->empty()) {
+    Optimizer->run(*F);
+  }
+  // Before streaming, which may drop the body the listener wants to see.
+  if (Listener != NULL) {
+    Listener->functionDecompiled(F);
+  }
+  streamFunction(F);
+}
+
+void Decompiler::streamFunction(Function *F) {
+  if (Streamer == NULL || F->empty()) {
+    return;
+  }
+  if (std::error_code EC = Streamer->writeFunction(F)) {
+    // Keep the body, it can still be saved with the module.
+    printError("Could not stream " + F->getName().str() + ": "
+      + EC.message());
+    return;
+  }
+  F->deleteBody();
+  Streamed.insert(F);
+}
+
+Function* Decompiler::decompileFunction(unsigned Address, Function *Into) {
   // Check that Address is inside the current section.
   // TODO: Find a better way to do this check. What we really care about is
   // avoiding reads to library calls and areas of memory we can't "see".
@@ -119,10 +229,14 @@ Function* Decompiler::decompileFunction(unsigned Address) {
   // TODO: Determine Function Type
   FunctionType *FType = FunctionType::get(Type::getPrimitiveType(*Context,
       Type::VoidTyID), false);
-  Function *F =
-    cast<Function>(Mod->getOrInsertFunction(MF->getName(), FType));
+  Function *F = Into;
+  if (F == NULL) {
+    F = cast<Function>(Mod->getOrInsertFunction(MF->getName(), FType));
+  }
 
-  if (!F->empty()) {
+  // Streamed functions were complete when they were dropped.
+  if (!F->empty() || isStreamed(F)) {
+    Dis->trimToBudget();
     return F;
   }
 
@@ -137,16 +251,16 @@ Function* Decompiler::decompileFunction(unsigned Address) {
     // Add branch from "entry"
     if (BI == MF->begin()) {
       entry->getInstList().push_back(
-        BranchInst::Create(getOrCreateBasicBlock(BI->getName(), F)));
+        BranchInst::Create(getOrCreateBasicBlock(getBlockName(BI, F), F)));
     } else {
-      getOrCreateBasicBlock(BI->getName(), F);
+      getOrCreateBasicBlock(getBlockName(BI, F), F);
     }
     ++BI;
   }
 
   BI = MF->begin();
   while (BI != BE) {
-    BI->dump();
+    DEBUG(BI->dump());
     if (decompileBasicBlock(BI, F) == NULL) {
       printError("Unable to decompile basic block!");
     }
@@ -221,14 +335,16 @@ Function* Decompiler::decompileFunction(unsigned Address) {
     splitBasicBlockIntoBlock(SB, SI, I);
   }
 
-  // Clean up unnecessary stores and loads
-  FunctionPassManager FPM(Mod);
-  //Line below adds decompiler optimization.  Function pass manager for optimization.
-  //    This is where to focus for type recovery.
-  // FPM.add(createPromoteMemoryToRegisterPass()); // See Scalar.h for more.
-  //FPM.add(createTypeRecoveryPass());
-  FPM.run(*F);
+  // The CFG is final now, so the phis for the registers can be placed.
+  if (UseRegisterSSA) {
+    RegSSA.run(*F);
+  }
+
+  // Further clean up and type recovery happen once the callees are named,
+  // see finishFunction and OptPipeline.
 
+  // The IR is done, the machine code can be decoded again if it is needed.
+  Dis->trimToBudget();
   return F;
 }
 
@@ -325,6 +441,22 @@ BasicBlock* Decompiler::decompileBasicBlock(MachineBasicBlock *MBB,
     DAG->viewGraph(MBB->getName());
   }
 
+  invertDAG(DAG);
+
+  printDAG(DAG);
+  if (ViewIRDAGs) {
+    DAG->viewGraph(MBB->getName());
+  }
+
+  BasicBlock *BB = emitDAG(DAG, getBlockName(MBB, F), F);
+  free(DAG);
+
+  return BB;
+}
+
+void Decompiler::invertDAG(SelectionDAG *NewDAG) {
+  Metrics::Scope Timer(Metrics::InvertTimer);
+  DAG = NewDAG;
   // Run the engine to decompile into SDNodes
   InvISel->SetDAG(DAG);
   DAG->AssignTopologicalOrder();
@@ -353,6 +485,7 @@ BasicBlock* Decompiler::decompileBasicBlock(MachineBasicBlock *MBB,
     //   continue;
 
     SDNode *ResNode = InvISel->Transmogrify(Node);
+    Metrics::get().count(Metrics::DAGNodesInverted);
 
     if (ResNode == Node || Node->getOpcode() == ISD::DELETED_NODE)
       continue;
@@ -365,14 +498,14 @@ BasicBlock* Decompiler::decompileBasicBlock(MachineBasicBlock *MBB,
     }
   }
   DAG->setRoot(Dummy.getValue());
+}
 
-  printDAG(DAG);
-  if (ViewIRDAGs) {
-    DAG->viewGraph(MBB->getName());
-  }
-
+BasicBlock* Decompiler::emitDAG(SelectionDAG *NewDAG, StringRef BBName,
+  Function *F) {
+  Metrics::Scope Timer(Metrics::EmitTimer);
+  DAG = NewDAG;
   // Create a new basic block (if necessary)
-  BasicBlock *BB = getOrCreateBasicBlock(MBB->getName(), F);
+  BasicBlock *BB = getOrCreateBasicBlock(BBName, F);
 
   // Convert the SDNodes into instructions inside the basic block
   // Infos << "OP_END: " << ISD::BUILTIN_OP_END << "\n";
@@ -391,13 +524,12 @@ BasicBlock* Decompiler::decompileBasicBlock(MachineBasicBlock *MBB,
     Emitter->EmitIR(BB, CurNode, NodeStack, OpMap);
   }
   Emitter->endDAG();
-  free(DAG);
-
   return BB;
 }
 
 SelectionDAG* Decompiler::createDAGFromMachineBasicBlock(
   MachineBasicBlock *MBB) {
+  Metrics::Scope Timer(Metrics::DAGBuildTimer);
 
   SelectionDAG *DAG =
     new SelectionDAG(*Dis->getMCDirector()->getTargetMachine(),
@@ -445,11 +577,10 @@ SelectionDAG* Decompiler::createDAGFromMachineBasicBlock(
         }
         continue;
       } else if (MOp->isImm()) {
-        // FIXME: Using MVT::i32 here is kinda messed up, we should be able
-        // to detect what type it is.
-        // As it stands, this will cause Inverse dag selector to fail to match
-        // on 64 bit instructions.
-        Ops.push_back(DAG->getConstant(MOp->getImm(), EVT(MVT::i32), false));
+        // The type has to agree with the target patterns or the inverse
+        // dag selector will fail to match (e.g., 64 bit instructions).
+        EVT ImmVT = Dis->getMCDirector()->getImmType(I->getDesc(), i);
+        Ops.push_back(DAG->getConstant(MOp->getImm(), ImmVT, false));
       } else {
         Ops.push_back(DAG->getUNDEF(EVT(MVT::i32)));
       }
@@ -488,6 +619,7 @@ SelectionDAG* Decompiler::createDAGFromMachineBasicBlock(
         CFRNode.getNode()->setDebugLoc(*Location);
         SDValue C2RNode = DAG->getCopyToReg(SDValue(CFRNode.getNode(),1), Loc, (unsigned) 1, CFRNode);
         C2RNode.getNode()->setDebugLoc(*Location);
+        delete Location;
         prevNode = C2RNode;
       }
     } else {
@@ -514,6 +646,7 @@ SelectionDAG* Decompiler::createDAGFromMachineBasicBlock(
     }
   }
   DAG->setRoot(prevNode);
+  Metrics::get().count(Metrics::DAGNodesCreated, DAG->allnodes_size());
 
   return DAG;
 }
@@ -743,6 +876,12 @@ void Decompiler::printDAG(SelectionDAG *DAG) {
   }
 }
 
+std::string Decompiler::getBlockName(const MachineBasicBlock *MBB,
+  const Function *F) const {
+  // "<machine function>+<offset>", with the offset kept.
+  return (F->getName() + "+" + MBB->getName().rsplit('+').second).str();
+}
+
 // Note: Users should not use this function if the BB is empty.
 uint64_t Decompiler::getBasicBlockAddress(BasicBlock *BB) {
   if (BB->empty()) {
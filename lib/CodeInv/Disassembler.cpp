@@ -15,6 +15,11 @@
 //===----------------------------------------------------------------------===//
 
 #include "CodeInv/Disassembler.h"
+#include "CodeInv/Metrics.h"
+#include "llvm/ADT/Triple.h"
+#include "llvm/IR/DataLayout.h"
+#include "llvm/MC/MCInstrAnalysis.h"
+#include "llvm/Target/TargetSubtargetInfo.h"
 
 using namespace llvm;
 
@@ -22,19 +27,12 @@ namespace fracture {
 
 Disassembler::Disassembler(MCDirector *NewMC, object::ObjectFile *NewExecutable,
   Module *NewModule, raw_ostream &InfoOut, raw_ostream &ErrOut)
-  : Infos(InfoOut), Errs(ErrOut) {
+  : Executable(NULL), CurSectionMemory(NULL), MemoryBudget(0),
+    ResidentSize(0), UseClock(0), TheModule(NewModule), Infos(InfoOut),
+    Errs(ErrOut) {
   MC = NewMC;
+  // Creates the module if it is null and sets the current section to ".text"
   setExecutable(NewExecutable);
-  // If the module is null then create a new one
-  if (NewModule == NULL) {
-    // TODO: getloadName may fail, how to resolve?
-    TheModule = new Module(Executable->getFileName(), *MC->getContext());
-  } else {
-    TheModule = NewModule;
-  }
-  // Set current section to ".text"
-  // setSection(".text");
-  setSection("text");
   // Initialize the MMI
   MMI = new MachineModuleInfo(*MC->getMCAsmInfo(), *MC->getMCRegisterInfo(),
     MC->getMCObjectFileInfo());
@@ -45,7 +43,7 @@ Disassembler::Disassembler(MCDirector *NewMC, object::ObjectFile *NewExecutable,
 Disassembler::~Disassembler() {
   // Note: BasicBlocks and Functions are also a part of TheModule, but we
   // still check to make sure they get deleted anyway.
-  delete MC;
+  // NOTE: The MCDirector may be shared, so it is left to its creator.
   delete TheModule;
   delete GMI;
   delete MMI;
@@ -71,6 +69,12 @@ Disassembler::~Disassembler() {
     if (I->second) errs() << "Disassembler: BasicBlock not deleted!\n";
   }
 
+  for (std::map<std::tuple<unsigned, uint64_t, uint64_t>,
+         MCInstrDesc*>::iterator I = Descs.begin(), E = Descs.end();
+       I != E; ++I) {
+    delete I->second;
+  }
+
 
   delete CurSectionMemory;
   delete Executable;
@@ -101,12 +105,14 @@ MachineFunction* Disassembler::disassemble(unsigned Address) {
   }
 
   Functions[Address] = MF;
+  FunctionUses[MF].LastUse = ++UseClock;
   return MF;
 }
 
 MachineBasicBlock* Disassembler::decodeBasicBlock(unsigned Address,
   MachineFunction* MF, unsigned &Size) {
   assert(MF && "Unable to decode basic block without Machine Function!");
+  Metrics::Scope Timer(Metrics::DecodeTimer);
 
   uint64_t MFLoc = MF->getFunctionNumber(); // FIXME: Horrible, horrible hack
   uint64_t Off = Address-MFLoc;
@@ -158,7 +164,7 @@ unsigned Disassembler::decodeInstruction(unsigned Address,
   if (!(DA->getInstruction(*Inst, InstSize, NewBytes, Address,
         nulls(), nulls()))) {
     printError("Unknown instruction encountered, instruction decode failed! ");
-    
+    Metrics::get().count(Metrics::DecodeFailures);
     return 1;
     // Instructions[Address] = NULL;
     // Block->push_back(NULL);
@@ -168,28 +174,33 @@ unsigned Disassembler::decodeInstruction(unsigned Address,
     // Dism->rawBytesToString(StringRef(Bytes.data() + Index, Size));
     // outs() << "   unkn\n";
   }
+  // The MachineInstr decoded here before, if any, only copied its operands.
+  delete Instructions[Address];
   Instructions[Address] = Inst;
+  Metrics::get().count(Metrics::InstsDecoded);
 
   // Recover Instruction information
   const MCInstrInfo *MII = MC->getMCInstrInfo();
-  MCInstrDesc *MCID = new MCInstrDesc(MII->get(Inst->getOpcode()));
-  MCID->Size = InstSize;
+  MCInstrDesc Desc = MII->get(Inst->getOpcode());
+  Desc.Size = InstSize;
 
   // Check if the instruction can load to program counter and mark it as a Ret
   // FIXME: Better analysis would be to see if the PC value references memory
   // sent as a parameter or set locally in the function, but that would need to
   // happen after decompilation. In either case, this is definitely a BB
   // terminator or branch!
-  if (MCID->mayLoad()
-    && MCID->mayAffectControlFlow(*Inst, *MC->getMCRegisterInfo())) {
-    MCID->Flags |= (1 << MCID::Return);
-    MCID->Flags |= (1 << MCID::Terminator);
+  if (Desc.mayLoad()
+    && Desc.mayAffectControlFlow(*Inst, *MC->getMCRegisterInfo())) {
+    Desc.Flags |= (1 << MCID::Return);
+    Desc.Flags |= (1 << MCID::Terminator);
   }
+  const MCInstrDesc *MCID = getInstrDesc(Desc);
 
 
   // Recover MachineInstr representation
   DebugLoc *Location = setDebugLoc(Address);
   MachineInstrBuilder MIB = BuildMI(Block, *Location, *MCID);
+  delete Location;
   unsigned int numDefs = MCID->getNumDefs();
   for (unsigned int i = 0; i < Inst->getNumOperands(); i++) {
     MCOperand MCO = Inst->getOperand(i);
@@ -253,6 +264,15 @@ unsigned Disassembler::decodeInstruction(unsigned Address,
     //outs() << "Name: " << MII->getName(Inst->getOpcode()) << " Flags: " << flags << "\n";
   }
 
+  // Rough cost of the instruction for the memory budget: the MCInst, the
+  // MachineInstr and their map entries.
+  const MachineInstr *MI = MIB;
+  uint64_t Cost = sizeof(MCInst) + Inst->getNumOperands() * sizeof(MCOperand)
+    + sizeof(MachineInstr) + MI->getNumOperands() * sizeof(MachineOperand)
+    + (flags != 0 ? sizeof(MachineMemOperand) : 0) + 12 * sizeof(void*);
+  FunctionUses[Block->getParent()].Size += Cost;
+  ResidentSize += Cost;
+
   // Note: I don't know why they decided instruction size needed to be 64 bits,
   // but the following conversion shouldn't be an issue.
   return ((unsigned)InstSize);
@@ -265,16 +285,16 @@ DebugLoc* Disassembler::setDebugLoc(uint64_t Address) {
   // The following sets the "scope" variable which actually holds the address.
   uint64_t AddrMask = dwarf::DW_TAG_lexical_block;
   Twine DIType = "0x" + Twine::utohexstr(AddrMask);
-  std::vector<Metadata*> *Elts = new std::vector<Metadata*>();
-  Elts->push_back(MDString::get(*MC->getContext(), StringRef(DIType.str())));
-  Elts->push_back(ValueAsMetadata::get(ConstantInt::get(Int64, Address)));
-  DIScope *Scope = new DIScope(MDNode::get(*MC->getContext(), *Elts));
+  std::vector<Metadata*> Elts;
+  Elts.push_back(MDString::get(*MC->getContext(), StringRef(DIType.str())));
+  Elts.push_back(ValueAsMetadata::get(ConstantInt::get(Int64, Address)));
+  DIScope Scope(MDNode::get(*MC->getContext(), Elts));
   // The following is here to fill in the value and not to be used to get
   // offsets
   unsigned ColVal = (Address & 0xFF000000) >> 24;
   unsigned LineVal = Address & 0xFFFFFF;
   DebugLoc *Location = new DebugLoc(DebugLoc::get(LineVal, ColVal,
-      Scope->get(), NULL));
+      Scope.get(), NULL));
 
   return Location;
 }
@@ -447,10 +467,38 @@ void Disassembler::printInstruction(formatted_raw_ostream &Out,
 
 
 void Disassembler::setExecutable(object::ObjectFile* NewExecutable) {
-  // NOTE: We don't do any reorging with the module or the machine functions. We
-  // need to evaluate if this is necessary. We should *not* change the MC API
-  // settings to match those of the executable.
+  // NOTE: We should *not* change the MC API settings to match those of the
+  // executable, the caller picks the MCDirector.
+  if (Executable != NULL && Executable != NewExecutable) {
+    // Everything decoded so far refers to the old executable, drop it.
+    for (std::map<unsigned, MCInst*>::iterator I = Instructions.begin(),
+           E = Instructions.end(); I != E; ++I) {
+      delete I->second;
+    }
+    for (std::map<unsigned, MachineFunction*>::iterator I = Functions.begin(),
+           E = Functions.end(); I != E; ++I) {
+      delete I->second;
+    }
+    Instructions.clear();
+    MachineInstructions.clear();
+    Functions.clear();
+    FunctionUses.clear();
+    ResidentSize = 0;
+    BasicBlocks.clear();
+    RelocOrigins.clear();
+    delete TheModule;
+    TheModule = NULL;
+    delete Executable;
+  }
   Executable = NewExecutable;
+
+  if (TheModule == NULL) {
+    // TODO: getloadName may fail, how to resolve?
+    TheModule = new Module(Executable->getFileName(), *MC->getContext());
+  }
+  // Set current section to ".text"
+  // setSection(".text");
+  setSection("text");
 }
 
 std::string Disassembler::getSymbolName(unsigned Address) {
@@ -713,9 +761,185 @@ void Disassembler::deleteFunction(MachineFunction *MF) {
     FuncItr++;
   }
   if (FuncItr != Functions.rend()) {
-    Functions.erase(FuncItr->first);
-    delete MF;
+    releaseFunction(MF);
+  }
+}
+
+void Disassembler::trimToBudget() {
+  if (MemoryBudget == 0) {
+    return;
+  }
+  while (ResidentSize > MemoryBudget && !FunctionUses.empty()) {
+    std::map<MachineFunction*, FunctionUse>::iterator Oldest =
+      FunctionUses.begin();
+    for (std::map<MachineFunction*, FunctionUse>::iterator
+           I = FunctionUses.begin(), E = FunctionUses.end(); I != E; ++I) {
+      if (I->second.LastUse < Oldest->second.LastUse) {
+        Oldest = I;
+      }
+    }
+    releaseFunction(Oldest->first);
+    Metrics::get().count(Metrics::FunctionsEvicted);
+  }
+}
+
+const MCInstrDesc* Disassembler::getInstrDesc(const MCInstrDesc &Desc) {
+  MCInstrDesc *&Shared =
+    Descs[std::make_tuple(unsigned(Desc.Opcode), uint64_t(Desc.Size),
+                          uint64_t(Desc.Flags))];
+  if (Shared == NULL) {
+    Shared = new MCInstrDesc(Desc);
+  }
+  return Shared;
+}
+
+void Disassembler::releaseFunction(MachineFunction *MF) {
+  std::vector<BasicBlock*> Dummies;
+  std::vector<unsigned> Addresses;
+  for (MachineFunction::iterator BI = MF->begin(), BE = MF->end(); BI != BE;
+       ++BI) {
+    Dummies.push_back(const_cast<BasicBlock*>(BI->getBasicBlock()));
+    for (MachineBasicBlock::instr_iterator II = BI->instr_begin(),
+           IE = BI->instr_end(); II != IE; ++II) {
+      Addresses.push_back(getDebugOffset(II->getDebugLoc()));
+    }
+  }
+
+  if (!Addresses.empty()) {
+    // Bytes that did not decode map to the instruction before them, so the
+    // entries can run past the last instruction.
+    unsigned Begin = *std::min_element(Addresses.begin(), Addresses.end());
+    unsigned Last = *std::max_element(Addresses.begin(), Addresses.end());
+    std::map<unsigned, const MachineInstr*>::iterator I =
+      MachineInstructions.lower_bound(Begin);
+    while (I != MachineInstructions.end()) {
+      bool Owned = I->second->getParent()->getParent() == MF;
+      if (!Owned && I->first > Last) {
+        break;
+      }
+      if (Owned) {
+        MachineInstructions.erase(I++);
+      } else {
+        ++I;
+      }
+    }
+  }
+  // Another function may have decoded the same bytes since, keep theirs.
+  for (unsigned i = 0, e = Addresses.size(); i != e; ++i) {
+    if (MachineInstructions.count(Addresses[i])) {
+      continue;
+    }
+    std::map<unsigned, MCInst*>::iterator I = Instructions.find(Addresses[i]);
+    if (I != Instructions.end()) {
+      delete I->second;
+      Instructions.erase(I);
+    }
+  }
+
+  for (std::map<unsigned, MachineFunction*>::iterator I = Functions.begin(),
+         E = Functions.end(); I != E; ++I) {
+    if (I->second == MF) {
+      Functions.erase(I);
+      break;
+    }
+  }
+  std::map<MachineFunction*, FunctionUse>::iterator Use =
+    FunctionUses.find(MF);
+  if (Use != FunctionUses.end()) {
+    ResidentSize -= Use->second.Size;
+    FunctionUses.erase(Use);
+  }
+  delete MF;
+
+  // The blocks only named the MachineBasicBlocks.
+  for (unsigned i = 0, e = Dummies.size(); i != e; ++i) {
+    if (Dummies[i] != NULL && Dummies[i]->getParent() == NULL) {
+      delete Dummies[i];
+    }
+  }
+}
+
+bool Disassembler::getInstTarget(const MachineInstr *MI,
+  uint64_t &Target) const {
+  uint64_t Address = getDebugOffset(MI->getDebugLoc());
+  unsigned Size = MI->getDesc().getSize();
+
+  // Direct branches and calls.
+  const MCInstrAnalysis *MIA = MC->getMCInstrAnalysis();
+  const MCInst *Inst = getMCInst(Address);
+  if ((MI->isBranch() || MI->isCall()) && MIA != NULL && Inst != NULL) {
+    return MIA->evaluateBranch(*Inst, Address, Size, Target);
+  }
+
+  // Loads with a PC based memory operand, e.g. ARM literal pool loads and
+  // x86-64 RIP relative loads.
+  if (!MI->mayLoad()) {
+    return false;
+  }
+  Triple::ArchType Arch =
+    Triple(MC->getTargetMachine()->getTargetTriple()).getArch();
+  for (unsigned i = 0, e = MI->getNumOperands(); i != e; ++i) {
+    const MachineOperand &MO = MI->getOperand(i);
+    if (!MO.isReg() || !MC->isPCReg(MO.getReg())) {
+      continue;
+    }
+    // Value of PC as read by the instruction, and the displacement operand.
+    uint64_t PC;
+    unsigned DispIdx;
+    switch (Arch) {
+      case Triple::arm:
+      case Triple::armeb:
+        PC = Address + 8;
+        DispIdx = i + 1;
+        break;
+      case Triple::thumb:
+      case Triple::thumbeb:
+        PC = (Address + 4) & ~3ULL;
+        DispIdx = i + 1;
+        break;
+      case Triple::x86:
+      case Triple::x86_64:
+        // Base, scale, index, displacement, segment.
+        PC = Address + Size;
+        DispIdx = i + 3;
+        break;
+      default:
+        return false;
+    }
+    if (DispIdx >= e || !MI->getOperand(DispIdx).isImm()) {
+      return false;
+    }
+    Target = PC + MI->getOperand(DispIdx).getImm();
+    return true;
+  }
+  return false;
+}
+
+bool Disassembler::readWord(uint64_t Address, unsigned Size,
+  uint64_t &Value) const {
+  uint8_t Bytes[8];
+  if (Size > sizeof(Bytes) || CurSectionMemory == NULL
+    || CurSectionMemory->readBytes(Bytes, Address, Size) != 0) {
+    return false;
+  }
+  bool LittleEndian = MC->getTargetMachine()->getSubtargetImpl()
+    ->getDataLayout()->isLittleEndian();
+  Value = 0;
+  for (unsigned i = 0; i != Size; ++i) {
+    Value = (Value << 8) | Bytes[LittleEndian ? Size - 1 - i : i];
+  }
+  return true;
+}
+
+bool Disassembler::getLoadedWord(const MachineInstr *MI,
+  uint64_t &Value) const {
+  uint64_t Target;
+  if (!MI->mayLoad() || !getInstTarget(MI, Target)) {
+    return false;
   }
+  unsigned PtrSize = MC->getTargetMachine()->getSubtargetImpl()
+    ->getDataLayout()->getPointerSize();
+  return readWord(Target, PtrSize, Value);
 }
 
 } // end namespace fracture
@@ -0,0 +1,322 @@
+//===--- FunctionDiscovery - Finds function extents in a section -*- C++ -*-===//
+//
+//              Fracture: The Draper Decompiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This class finds the functions in a section of code with a recursive
+// descent from known entry points followed by a linear sweep of the gaps.
+//
+//===----------------------------------------------------------------------===//
+
+#include "CodeInv/FunctionDiscovery.h"
+#include "CodeInv/Disassembler.h"
+
+#include "llvm/ADT/Statistic.h"
+
+#include <algorithm>
+
+using namespace llvm;
+
+#define DEBUG_TYPE "function-discovery"
+
+STATISTIC(NumDecoded, "Number of instructions decoded during discovery");
+STATISTIC(NumSweepSeeds, "Number of functions found by the linear sweep");
+STATISTIC(NumCandidateSeeds, "Number of functions found from candidates");
+
+namespace fracture {
+
+FunctionDiscovery::FunctionDiscovery(const MCDirector *TheMC,
+  ArrayRef<uint8_t> SectBytes, uint64_t SectBase, raw_ostream &InfoOut,
+  raw_ostream &ErrOut) : MC(TheMC),
+  Sigs(TheMC, TheMC->getTargetMachine()->getTargetTriple()),
+  Bytes(SectBytes), Base(SectBase), Infos(InfoOut), Errs(ErrOut) {
+  init();
+}
+
+FunctionDiscovery::FunctionDiscovery(const Disassembler *DAS,
+  raw_ostream &InfoOut, raw_ostream &ErrOut) : MC(DAS->getMCDirector()),
+  Sigs(MC, MC->getTargetMachine()->getTargetTriple()), Infos(InfoOut),
+  Errs(ErrOut) {
+  FractureMemoryObject *Mem = DAS->getCurSectionMemory();
+  StringRef SectBytes = Mem->getBytes();
+  Bytes = ArrayRef<uint8_t>((const uint8_t*)SectBytes.data(),
+    SectBytes.size());
+  Base = Mem->getBase();
+  init();
+}
+
+void FunctionDiscovery::init() {
+  InstIndex.assign(Bytes.size(), Undecoded);
+  Covered.resize(Bytes.size());
+  Leaders.resize(Bytes.size());
+  NumFromCandidates = 0;
+}
+
+void FunctionDiscovery::addSeed(uint64_t Address) {
+  if (contains(Address) && Functions.find(Address) == Functions.end()) {
+    Seeds.push_back(Address);
+  }
+}
+
+void FunctionDiscovery::addCandidate(uint64_t Address) {
+  if (contains(Address)) {
+    Candidates.push_back(Address);
+  }
+}
+
+void FunctionDiscovery::addSymbolSeeds(const object::ObjectFile *Executable) {
+  for (object::symbol_iterator I = Executable->symbols().begin(),
+         E = Executable->symbols().end(); I != E; ++I) {
+    object::SymbolRef::Type SymType;
+    uint64_t SymAddr;
+    if (I->getType(SymType) || SymType != object::SymbolRef::ST_Function) {
+      continue;
+    }
+    if (I->getAddress(SymAddr) || SymAddr == object::UnknownAddressOrSize) {
+      continue;
+    }
+    addSeed(SymAddr);
+  }
+}
+
+void FunctionDiscovery::run(bool Sweep) {
+  processSeeds();
+  processCandidates();
+  if (!Sweep) {
+    return;
+  }
+
+  // Linear sweep over whatever the descent did not reach. Padding and bytes
+  // that do not decode are skipped, anything else starts a new function.
+  uint64_t Offset = 0, End = Bytes.size();
+  while (Offset < End) {
+    if (Covered[Offset]) {
+      ++Offset;
+      continue;
+    }
+    uint64_t Address = Base + Offset;
+    DecodedInst *DI = decode(Address);
+    if (DI == NULL) {
+      ++Offset;
+      continue;
+    }
+    if (isPadding(Address, *DI)) {
+      Offset += DI->Size;
+      continue;
+    }
+    ++NumSweepSeeds;
+    addSeed(Address);
+    processSeeds();
+  }
+}
+
+uint64_t FunctionDiscovery::getFunctionAt(uint64_t Address) const {
+  if (!contains(Address) || InstIndex[Address - Base] < 0) {
+    return NoFunction;
+  }
+  return Insts[InstIndex[Address - Base]].Function;
+}
+
+const MCInst* FunctionDiscovery::getInst(uint64_t Address) const {
+  if (!contains(Address) || InstIndex[Address - Base] < 0) {
+    return NULL;
+  }
+  return &Insts[InstIndex[Address - Base]].Inst;
+}
+
+unsigned FunctionDiscovery::getInstSize(uint64_t Address) const {
+  if (!contains(Address) || InstIndex[Address - Base] < 0) {
+    return 0;
+  }
+  return Insts[InstIndex[Address - Base]].Size;
+}
+
+FunctionDiscovery::DecodedInst* FunctionDiscovery::decode(uint64_t Address) {
+  uint64_t Offset = Address - Base;
+  if (InstIndex[Offset] == Invalid) {
+    return NULL;
+  }
+  if (InstIndex[Offset] != Undecoded) {
+    return &Insts[InstIndex[Offset]];
+  }
+
+  DecodedInst DI;
+  uint64_t InstSize;
+  if (!MC->getMCDisassembler()->getInstruction(DI.Inst, InstSize,
+        Bytes.slice(Offset), Address, nulls(), nulls())
+    || InstSize == 0 || Offset + InstSize > Bytes.size()) {
+    InstIndex[Offset] = Invalid;
+    return NULL;
+  }
+  ++NumDecoded;
+  DI.Size = InstSize;
+  DI.Function = NoFunction;
+  DI.EndsBlock = false;
+  DI.FallsThrough = true;
+  InstIndex[Offset] = Insts.size();
+  Insts.push_back(DI);
+  return &Insts.back();
+}
+
+bool FunctionDiscovery::isPadding(uint64_t Address,
+  const DecodedInst &DI) const {
+  if (Sigs.isA(StrippedSignatures::NopPadding, DI.Inst)) {
+    return true;
+  }
+  // Zero fill decodes to something on most targets, but is never code.
+  for (unsigned i = 0; i != DI.Size; ++i) {
+    if (Bytes[Address - Base + i] != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void FunctionDiscovery::processSeeds() {
+  while (!Seeds.empty()) {
+    uint64_t Entry = Seeds.back();
+    Seeds.pop_back();
+    descend(Entry);
+  }
+}
+
+void FunctionDiscovery::processCandidates() {
+  std::sort(Candidates.begin(), Candidates.end());
+  Candidates.erase(std::unique(Candidates.begin(), Candidates.end()),
+    Candidates.end());
+  for (unsigned i = 0, e = Candidates.size(); i != e; ++i) {
+    uint64_t Address = Candidates[i];
+    if (Covered[Address - Base] || Functions.count(Address)) {
+      continue;
+    }
+    ++NumCandidateSeeds;
+    ++NumFromCandidates;
+    addSeed(Address);
+    processSeeds();
+  }
+  Candidates.clear();
+}
+
+void FunctionDiscovery::descend(uint64_t Entry) {
+  if (Functions.find(Entry) != Functions.end() || Covered[Entry - Base]) {
+    return;
+  }
+
+  const MCInstrAnalysis *MIA = MC->getMCInstrAnalysis();
+  const MCRegisterInfo *MRI = MC->getMCRegisterInfo();
+  const MCInstrInfo *MII = MC->getMCInstrInfo();
+
+  uint64_t End = Entry;
+  std::vector<uint64_t> Blocks;
+  Blocks.push_back(Entry);
+  Leaders.set(Entry - Base);
+  while (!Blocks.empty()) {
+    uint64_t Address = Blocks.back();
+    Blocks.pop_back();
+
+    // Decode straight through the block. Stops at code owned by any
+    // function, including this one.
+    while (contains(Address) && !Covered[Address - Base]) {
+      DecodedInst *DI = decode(Address);
+      if (DI == NULL || DI->Function != NoFunction) {
+        break;
+      }
+      DI->Function = Entry;
+      Covered.set(Address - Base, Address - Base + DI->Size);
+      End = std::max(End, Address + DI->Size);
+
+      const MCInst &Inst = DI->Inst;
+      const MCInstrDesc &Desc = MII->get(Inst.getOpcode());
+      uint64_t InstAddr = Address;
+      uint64_t Target = 0;
+      bool HasTarget = MIA->evaluateBranch(Inst, Address, DI->Size, Target)
+        && contains(Target);
+      Address += DI->Size;
+
+      if (MIA->isCall(Inst)) {
+        if (HasTarget) {
+          addSeed(Target);
+        }
+        continue;
+      }
+      if (MIA->isReturn(Inst)) {
+        DI->EndsBlock = true;
+        DI->FallsThrough = false;
+        break;
+      }
+      if (MIA->isBranch(Inst)) {
+        DI->EndsBlock = true;
+        // Jumps to known functions are tail calls, not blocks.
+        if (HasTarget && Functions.find(Target) == Functions.end()) {
+          Blocks.push_back(Target);
+          Leaders.set(Target - Base);
+          Edges.push_back(std::make_pair(InstAddr, Target));
+        }
+        if (MIA->isUnconditionalBranch(Inst) || MIA->isIndirectBranch(Inst)) {
+          DI->FallsThrough = false;
+          break;
+        }
+        if (contains(Address)) {
+          Leaders.set(Address - Base);
+        }
+        continue;
+      }
+      // e.g., loads to PC on ARM.
+      if (MIA->isTerminator(Inst) || Desc.mayAffectControlFlow(Inst, *MRI)) {
+        DI->EndsBlock = true;
+        DI->FallsThrough = false;
+        break;
+      }
+    }
+  }
+
+  // Nothing decoded at the entry, e.g. a call into data.
+  if (End != Entry) {
+    Functions[Entry] = End;
+  }
+}
+
+void FunctionDiscovery::buildCFG(CompactCFG &CFG) const {
+  // Walk the owned instructions in address order, cutting blocks at leaders,
+  // block ending instructions, gaps and function boundaries.
+  bool InBlock = false, PrevEndsBlock = false, PrevFallsThrough = false;
+  uint64_t BlockStart = 0, PrevAddr = 0, PrevEnd = 0, PrevFunc = NoFunction;
+  for (uint64_t Offset = 0, E = Bytes.size(); Offset != E; ++Offset) {
+    int Idx = InstIndex[Offset];
+    if (Idx < 0 || Insts[Idx].Function == NoFunction) {
+      continue;
+    }
+    const DecodedInst &DI = Insts[Idx];
+    uint64_t Address = Base + Offset;
+    bool Adjacent = InBlock && Address == PrevEnd
+      && DI.Function == PrevFunc;
+    if (!Adjacent || Leaders.test(Offset) || PrevEndsBlock) {
+      if (InBlock) {
+        CFG.addBlock(BlockStart, PrevEnd);
+        if (Adjacent && PrevFallsThrough) {
+          CFG.addEdge(PrevAddr, Address);
+        }
+      }
+      BlockStart = Address;
+      InBlock = true;
+    }
+    PrevAddr = Address;
+    PrevEnd = Address + DI.Size;
+    PrevFunc = DI.Function;
+    PrevEndsBlock = DI.EndsBlock;
+    PrevFallsThrough = DI.FallsThrough;
+  }
+  if (InBlock) {
+    CFG.addBlock(BlockStart, PrevEnd);
+  }
+
+  for (unsigned i = 0, e = Edges.size(); i != e; ++i) {
+    CFG.addEdge(Edges[i].first, Edges[i].second);
+  }
+}
+
+} // end namespace fracture
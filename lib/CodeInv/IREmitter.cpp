@@ -16,6 +16,9 @@
 
 #include "CodeInv/IREmitter.h"
 #include "CodeInv/Decompiler.h"
+#include "CodeInv/Metrics.h"
+#include "llvm/ADT/Triple.h"
+#include "llvm/IR/Intrinsics.h"
 
 using namespace llvm;
 
@@ -28,8 +31,7 @@ IREmitter::IREmitter(Decompiler *TheDec, raw_ostream &InfoOut,
   Dec = TheDec;
   DAG = Dec->getCurrentDAG();
   IRB = new IRBuilder<>(getGlobalContext());
-  RegMap.grow(Dec->getDisassembler()->getMCDirector()->getMCRegisterInfo(
-     )->getNumRegs());
+  RegMap.grow(Dec->getDisassembler()->getMCDirector()->getNumRegs());
 }
 
 IREmitter::~IREmitter() {
@@ -56,9 +58,9 @@ void IREmitter::EmitIR(BasicBlock *BB, SDNode *CurNode,
     // Reset Data Structures
     RegMap.clear();
     VisitMap.clear();
+    FlagsMap.clear();
     BaseNames.clear();
-    RegMap.grow(Dec->getDisassembler()->getMCDirector()->getMCRegisterInfo(
-     )->getNumRegs());
+    RegMap.grow(Dec->getDisassembler()->getMCDirector()->getNumRegs());
   }
 }
 
@@ -125,6 +127,190 @@ StringRef IREmitter::getInstructionName(const SDNode *N) {
   return StringRef();
 }
 
+const char* IREmitter::getTargetName() const {
+  Triple TT(Dec->getDisassembler()->getMCDirector()->getTargetMachine()
+    ->getTargetTriple());
+  return Triple::getArchTypeName(TT.getArch());
+}
+
+void IREmitter::recordFlags(const SDNode *N, LazyFlags::FlagOp Op, Value *LHS,
+  Value *RHS, Value *Res) {
+  assert((Op != LazyFlags::Logic || Res != NULL) && "Logic flags need Res!");
+  LazyFlags &Flags = FlagsMap[N];
+  Flags.Op = Op;
+  Flags.LHS = LHS;
+  Flags.RHS = RHS;
+  Flags.Res = Res;
+}
+
+Value* IREmitter::getFlagsResult(LazyFlags &Flags) {
+  if (Flags.Res == NULL) {
+    if (Flags.Op == LazyFlags::Add)
+      Flags.Res = IRB->CreateAdd(Flags.LHS, Flags.RHS);
+    else
+      Flags.Res = IRB->CreateSub(Flags.LHS, Flags.RHS);
+  }
+  return Flags.Res;
+}
+
+Value* IREmitter::getCarryFlag(LazyFlags &Flags) {
+  switch (Flags.Op) {
+  case LazyFlags::Sub:
+    // Set when there is no borrow.
+    return IRB->CreateICmpUGE(Flags.LHS, Flags.RHS);
+  case LazyFlags::Add:
+    // LHS + RHS carries out exactly when LHS > ~RHS.
+    return IRB->CreateICmpUGT(Flags.LHS, IRB->CreateNot(Flags.RHS));
+  case LazyFlags::Logic:
+    break;
+  }
+  return IRB->getFalse();
+}
+
+Value* IREmitter::getOverflowFlag(LazyFlags &Flags) {
+  if (Flags.Op == LazyFlags::Logic)
+    return IRB->getFalse();
+  Intrinsic::ID ID = Flags.Op == LazyFlags::Add ?
+    Intrinsic::sadd_with_overflow : Intrinsic::ssub_with_overflow;
+  Function *Fn = Intrinsic::getDeclaration(Dec->getModule(), ID,
+    Flags.LHS->getType());
+  Value *Ops[] = { Flags.LHS, Flags.RHS };
+  return IRB->CreateExtractValue(IRB->CreateCall(Fn, Ops), 1);
+}
+
+Value* IREmitter::getFlagCondition(const SDNode *FlagsNode, FlagCond Cond) {
+  if (!FlagsMap.count(FlagsNode))
+    visit(FlagsNode);
+  DenseMap<const SDNode*, LazyFlags>::iterator It = FlagsMap.find(FlagsNode);
+  if (It == FlagsMap.end())
+    return NULL;
+  LazyFlags &Flags = It->second;
+  Value *LHS = Flags.LHS, *RHS = Flags.RHS;
+
+  // The common conditions are a single compare of the operands.
+  switch (Flags.Op) {
+  case LazyFlags::Sub:
+    switch (Cond) {
+    default: break;
+    case FC_EQ:  return IRB->CreateICmpEQ(LHS, RHS);
+    case FC_NE:  return IRB->CreateICmpNE(LHS, RHS);
+    case FC_UGE: return IRB->CreateICmpUGE(LHS, RHS);
+    case FC_ULT: return IRB->CreateICmpULT(LHS, RHS);
+    case FC_UGT: return IRB->CreateICmpUGT(LHS, RHS);
+    case FC_ULE: return IRB->CreateICmpULE(LHS, RHS);
+    case FC_SGE: return IRB->CreateICmpSGE(LHS, RHS);
+    case FC_SLT: return IRB->CreateICmpSLT(LHS, RHS);
+    case FC_SGT: return IRB->CreateICmpSGT(LHS, RHS);
+    case FC_SLE: return IRB->CreateICmpSLE(LHS, RHS);
+    }
+    break;
+  case LazyFlags::Add:
+    // The negation and the not fold away when RHS is a constant.
+    switch (Cond) {
+    default: break;
+    case FC_EQ:  return IRB->CreateICmpEQ(LHS, IRB->CreateNeg(RHS));
+    case FC_NE:  return IRB->CreateICmpNE(LHS, IRB->CreateNeg(RHS));
+    case FC_UGE: return getCarryFlag(Flags);
+    case FC_ULT: return IRB->CreateICmpULE(LHS, IRB->CreateNot(RHS));
+    }
+    break;
+  case LazyFlags::Logic: {
+    // Carry and overflow are clear, so this is comparing the result with 0.
+    Value *Res = Flags.Res;
+    Value *Zero = Constant::getNullValue(Res->getType());
+    switch (Cond) {
+    case FC_EQ: case FC_ULE: return IRB->CreateICmpEQ(Res, Zero);
+    case FC_NE: case FC_UGT: return IRB->CreateICmpNE(Res, Zero);
+    case FC_SGE: case FC_PL: return IRB->CreateICmpSGE(Res, Zero);
+    case FC_SLT: case FC_MI: return IRB->CreateICmpSLT(Res, Zero);
+    case FC_SGT:             return IRB->CreateICmpSGT(Res, Zero);
+    case FC_SLE:             return IRB->CreateICmpSLE(Res, Zero);
+    case FC_UGE: case FC_VC: return IRB->getTrue();
+    case FC_ULT: case FC_VS: return IRB->getFalse();
+    }
+    break;
+  }
+  }
+
+  // The rest need the individual flags, built from the result.
+  Value *Res = getFlagsResult(Flags);
+  Value *Zero = Constant::getNullValue(Res->getType());
+  switch (Cond) {
+  default: break;
+  case FC_MI: return IRB->CreateICmpSLT(Res, Zero);
+  case FC_PL: return IRB->CreateICmpSGE(Res, Zero);
+  case FC_VS: return getOverflowFlag(Flags);
+  case FC_VC: return IRB->CreateNot(getOverflowFlag(Flags));
+  case FC_UGT:
+    return IRB->CreateAnd(getCarryFlag(Flags), IRB->CreateICmpNE(Res, Zero));
+  case FC_ULE:
+    return IRB->CreateOr(IRB->CreateNot(getCarryFlag(Flags)),
+      IRB->CreateICmpEQ(Res, Zero));
+  }
+  // Signed conditions: greater or equal is N == V.
+  Value *GE = IRB->CreateICmpEQ(IRB->CreateICmpSLT(Res, Zero),
+    getOverflowFlag(Flags));
+  switch (Cond) {
+  default: break;
+  case FC_SGE: return GE;
+  case FC_SLT: return IRB->CreateNot(GE);
+  case FC_SGT: return IRB->CreateAnd(GE, IRB->CreateICmpNE(Res, Zero));
+  case FC_SLE:
+    return IRB->CreateOr(IRB->CreateNot(GE), IRB->CreateICmpEQ(Res, Zero));
+  }
+  llvm_unreachable("IREmitter::getFlagCondition: unknown condition");
+}
+
+Value* IREmitter::visitUnhandled(const SDNode *N) {
+  std::string NodeName = N->getOperationName(DAG);
+  Metrics::get().countUnhandled(getTargetName(), NodeName);
+
+  CoverageProfile *Profile = Dec->getCoverageProfile();
+  if (Profile == NULL) {
+    errs() << "OpCode: " << NodeName << "\n";
+    N->dump();
+    // Not llvm_unreachable: a batch worker's fatal error handler still has
+    // to pass the count above back to its parent.
+    report_fatal_error("IREmitter::visitUnhandled - Every visit should be "
+      "implemented...");
+  }
+
+  const Disassembler *Dis = Dec->getDisassembler();
+  uint64_t Address = Dis->getDebugOffset(N->getDebugLoc());
+  StringRef Opcode;
+  if (const MachineInstr *MI = Dis->getMachineInstr(Address))
+    Opcode = Dis->getMCDirector()->getMCInstrInfo()->getName(MI->getOpcode());
+  Profile->record(getTargetName(), Opcode, NodeName, Address);
+
+  // The placeholder takes the address and whatever operand values can be
+  // emitted, and returns the node's first value if it is a plain type.
+  LLVMContext &Ctx = Dec->getModule()->getContext();
+  std::vector<Value*> Args;
+  Args.push_back(IRB->getInt64(Address));
+  for (unsigned i = 0, e = N->getNumOperands(); i != e; ++i) {
+    EVT OpVT = N->getOperand(i).getValueType();
+    if (OpVT == MVT::Other || OpVT == MVT::Glue)
+      continue;
+    if (Value *Op = visit(N->getOperand(i).getNode()))
+      Args.push_back(Op);
+  }
+  EVT VT = N->getNumValues() ? N->getValueType(0) : EVT(MVT::Other);
+  Type *RetTy = Type::getVoidTy(Ctx);
+  std::string FName = "fracture.unhandled." + NodeName;
+  if (VT.isSimple() && VT != MVT::Other && VT != MVT::Glue
+    && VT != MVT::Untyped) {
+    RetTy = VT.getTypeForEVT(Ctx);
+    FName += "." + VT.getEVTString();
+  }
+  FunctionType *FT = FunctionType::get(RetTy, IRB->getInt64Ty(), true);
+  Value *Proto = Dec->getModule()->getOrInsertFunction(FName, FT);
+  Value *Res = IRB->CreateCall(Proto, Args);
+  if (RetTy->isVoidTy())
+    Res = NULL;
+  VisitMap[N] = Res;
+  return Res;
+}
+
 Value* IREmitter::visit(const SDNode *N) {
   // Note: Extenders of this class should probably copy the following block
   // Also note, however, that it is up to the visit function wether to save to
@@ -141,12 +327,8 @@ Value* IREmitter::visit(const SDNode *N) {
   DEBUG(Infos << format("%1" PRIx64, Dec->getDisassembler()->getDebugOffset(N->getDebugLoc())) << "\n");
 
   switch (N->getOpcode()) {
-    default:{
-      errs() << "OpCode: " << N->getOpcode() << "\n";
-      N->dump();
-      llvm_unreachable("IREmitter::visit - Every visit should be implemented...");
-      return NULL;
-    }
+    default:
+      return visitUnhandled(N);
     // Do nothing nodes
     case ISD::EntryToken:         return NULL;
     case ISD::HANDLENODE:         EndHandleDAG = true;
@@ -261,6 +443,10 @@ Value* IREmitter::visitCopyToReg(const SDNode *N) {
   Value *RegVal = visitRegister(N->getOperand(1).getNode());
   Value* V = visit(N->getOperand(2).getNode());
 
+  // Flags are computed by their consumers; there is nothing to store.
+  if (V == NULL && FlagsMap.count(N->getOperand(2).getNode()))
+    return NULL;
+
   if (V == NULL || RegVal == NULL) {
     errs() << "Null values on CopyToReg, skipping!\n";
     return NULL;
@@ -291,8 +477,8 @@ Value* IREmitter::visitConstant(const SDNode *N) {
 }
 
 
-Value* IREmitter::visitTokenFactor(const SDNode *N) { llvm_unreachable("visitTokenFactor Unimplemented visit..."); return NULL; }
-Value* IREmitter::visitMERGE_VALUES(const SDNode *N) { llvm_unreachable("visitMERGE_VALUES Unimplemented visit..."); return NULL; }
+Value* IREmitter::visitTokenFactor(const SDNode *N) { return visitUnhandled(N); }
+Value* IREmitter::visitMERGE_VALUES(const SDNode *N) { return visitUnhandled(N); }
 
 Value* IREmitter::visitADD(const SDNode *N) {
   // Operand 0 and 1 are values to add
@@ -331,10 +517,10 @@ Value* IREmitter::visitSUB(const SDNode *N) {
   return Res;
 }
 
-Value* IREmitter::visitADDC(const SDNode *N) { llvm_unreachable("visitADDC Unimplemented visit..."); return NULL; }
-Value* IREmitter::visitSUBC(const SDNode *N) { llvm_unreachable("visitSUBC Unimplemented visit..."); return NULL; }
-Value* IREmitter::visitADDE(const SDNode *N) { llvm_unreachable("visitADDE Unimplemented visit..."); return NULL; }
-Value* IREmitter::visitSUBE(const SDNode *N) { llvm_unreachable("visitSUBE Unimplemented visit..."); return NULL; }
+Value* IREmitter::visitADDC(const SDNode *N) { return visitUnhandled(N); }
+Value* IREmitter::visitSUBC(const SDNode *N) { return visitUnhandled(N); }
+Value* IREmitter::visitADDE(const SDNode *N) { return visitUnhandled(N); }
+Value* IREmitter::visitSUBE(const SDNode *N) { return visitUnhandled(N); }
 
 Value* IREmitter::visitMUL(const SDNode *N) {
   // Operand 0 and 1 are values to sub
@@ -355,18 +541,18 @@ Value* IREmitter::visitMUL(const SDNode *N) {
   return Res;
 }
 
-Value* IREmitter::visitSDIV(const SDNode *N) { llvm_unreachable("visitSDIV Unimplemented visit..."); return NULL; }
-Value* IREmitter::visitUDIV(const SDNode *N) { llvm_unreachable("visitUDIV Unimplemented visit..."); return NULL; }
-Value* IREmitter::visitSREM(const SDNode *N) { llvm_unreachable("visitSREM Unimplemented visit..."); return NULL; }
-Value* IREmitter::visitUREM(const SDNode *N) { llvm_unreachable("visitUREM Unimplemented visit..."); return NULL; }
-Value* IREmitter::visitMULHU(const SDNode *N) { llvm_unreachable("visitMULHU Unimplemented visit..."); return NULL; }
-Value* IREmitter::visitMULHS(const SDNode *N) { llvm_unreachable("visitMULHS Unimplemented visit..."); return NULL; }
-Value* IREmitter::visitSMUL_LOHI(const SDNode *N) { llvm_unreachable("visitSMUL_LOHI Unimplemented visit..."); return NULL; }
-Value* IREmitter::visitUMUL_LOHI(const SDNode *N) { llvm_unreachable("visitUMUL_LOHI Unimplemented visit..."); return NULL; }
-Value* IREmitter::visitSMULO(const SDNode *N) { llvm_unreachable("visitSMULO Unimplemented visit..."); return NULL; }
-Value* IREmitter::visitUMULO(const SDNode *N) { llvm_unreachable("visitUMULO Unimplemented visit..."); return NULL; }
-Value* IREmitter::visitSDIVREM(const SDNode *N) { llvm_unreachable("visitSDIVREM Unimplemented visit..."); return NULL; }
-Value* IREmitter::visitUDIVREM(const SDNode *N) { llvm_unreachable("visitUDIVREM Unimplemented visit..."); return NULL; }
+Value* IREmitter::visitSDIV(const SDNode *N) { return visitUnhandled(N); }
+Value* IREmitter::visitUDIV(const SDNode *N) { return visitUnhandled(N); }
+Value* IREmitter::visitSREM(const SDNode *N) { return visitUnhandled(N); }
+Value* IREmitter::visitUREM(const SDNode *N) { return visitUnhandled(N); }
+Value* IREmitter::visitMULHU(const SDNode *N) { return visitUnhandled(N); }
+Value* IREmitter::visitMULHS(const SDNode *N) { return visitUnhandled(N); }
+Value* IREmitter::visitSMUL_LOHI(const SDNode *N) { return visitUnhandled(N); }
+Value* IREmitter::visitUMUL_LOHI(const SDNode *N) { return visitUnhandled(N); }
+Value* IREmitter::visitSMULO(const SDNode *N) { return visitUnhandled(N); }
+Value* IREmitter::visitUMULO(const SDNode *N) { return visitUnhandled(N); }
+Value* IREmitter::visitSDIVREM(const SDNode *N) { return visitUnhandled(N); }
+Value* IREmitter::visitUDIVREM(const SDNode *N) { return visitUnhandled(N); }
 Value* IREmitter::visitAND(const SDNode *N) {
   // Operand 0 and 1 are values to sub
   Value *Op0 = visit(N->getOperand(0).getNode());
@@ -419,45 +605,45 @@ Value* IREmitter::visitXOR(const SDNode *N) {
   VisitMap[N] = Res;
   return Res;
 }
-Value* IREmitter::visitSHL(const SDNode *N) { llvm_unreachable("visitSHL Unimplemented visit..."); return NULL; }
-Value* IREmitter::visitSRA(const SDNode *N) { llvm_unreachable("visitSRA Unimplemented visit..."); return NULL; }
-Value* IREmitter::visitSRL(const SDNode *N) { llvm_unreachable("visitSRL Unimplemented visit..."); return NULL; }
-Value* IREmitter::visitCTLZ(const SDNode *N) { llvm_unreachable("visitCTLZ Unimplemented visit..."); return NULL; }
-Value* IREmitter::visitCTLZ_ZERO_UNDEF(const SDNode *N) { llvm_unreachable("visitCTLZ_ZERO_UNDEF Unimplemented visit..."); return NULL; }
-Value* IREmitter::visitCTTZ(const SDNode *N) { llvm_unreachable("visitCTTZ Unimplemented visit..."); return NULL; }
-Value* IREmitter::visitCTTZ_ZERO_UNDEF(const SDNode *N) { llvm_unreachable("visitCTTZ_ZERO_UNDEF Unimplemented visit..."); return NULL; }
-Value* IREmitter::visitCTPOP(const SDNode *N) { llvm_unreachable("visitCTPOP Unimplemented visit..."); return NULL; }
-Value* IREmitter::visitSELECT(const SDNode *N) { llvm_unreachable("visitSELECT Unimplemented visit..."); return NULL; }
-Value* IREmitter::visitVSELECT(const SDNode *N) { llvm_unreachable("visitVSELECT Unimplemented visit..."); return NULL; }
-Value* IREmitter::visitSELECT_CC(const SDNode *N) { llvm_unreachable("visitSELECT_CC Unimplemented visit..."); return NULL; }
-Value* IREmitter::visitSETCC(const SDNode *N) { llvm_unreachable("visitSETCC Unimplemented visit..."); return NULL; }
-Value* IREmitter::visitSIGN_EXTEND(const SDNode *N) { llvm_unreachable("visitSIGN_EXTEND Unimplemented visit..."); return NULL; }
-Value* IREmitter::visitZERO_EXTEND(const SDNode *N) { llvm_unreachable("visitZERO_EXTEND Unimplemented visit..."); return NULL; }
-Value* IREmitter::visitANY_EXTEND(const SDNode *N) { llvm_unreachable("visitANY_EXTEND Unimplemented visit..."); return NULL; }
-Value* IREmitter::visitSIGN_EXTEND_INREG(const SDNode *N) { llvm_unreachable("visitSIGN_EXTEND_INREG Unimplemented visit..."); return NULL; }
-Value* IREmitter::visitTRUNCATE(const SDNode *N) { llvm_unreachable("visitTRUNCATE Unimplemented visit..."); return NULL; }
-Value* IREmitter::visitBITCAST(const SDNode *N) { llvm_unreachable("visitBITCAST Unimplemented visit..."); return NULL; }
-Value* IREmitter::visitBUILD_PAIR(const SDNode *N) { llvm_unreachable("visitBUILD_PAIR Unimplemented visit..."); return NULL; }
-Value* IREmitter::visitFADD(const SDNode *N) { llvm_unreachable("visitFADD Unimplemented visit..."); return NULL; }
-Value* IREmitter::visitFSUB(const SDNode *N) { llvm_unreachable("visitFSUB Unimplemented visit..."); return NULL; }
-Value* IREmitter::visitFMUL(const SDNode *N) { llvm_unreachable("visitFMUL Unimplemented visit..."); return NULL; }
-Value* IREmitter::visitFMA(const SDNode *N) { llvm_unreachable("visitFMA Unimplemented visit..."); return NULL; }
-Value* IREmitter::visitFDIV(const SDNode *N) { llvm_unreachable("visitFDIV Unimplemented visit..."); return NULL; }
-Value* IREmitter::visitFREM(const SDNode *N) { llvm_unreachable("visitFREM Unimplemented visit..."); return NULL; }
-Value* IREmitter::visitFCOPYSIGN(const SDNode *N) { llvm_unreachable("visitFCOPYSIGN Unimplemented visit..."); return NULL; }
-Value* IREmitter::visitSINT_TO_FP(const SDNode *N) { llvm_unreachable("visitSINT_TO_FP Unimplemented visit..."); return NULL; }
-Value* IREmitter::visitUINT_TO_FP(const SDNode *N) { llvm_unreachable("visitUINT_TO_FP Unimplemented visit..."); return NULL; }
-Value* IREmitter::visitFP_TO_SINT(const SDNode *N) { llvm_unreachable("visitFP_TO_SINT Unimplemented visit..."); return NULL; }
-Value* IREmitter::visitFP_TO_UINT(const SDNode *N) { llvm_unreachable("visitFP_TO_UINT Unimplemented visit..."); return NULL; }
-Value* IREmitter::visitFP_ROUND(const SDNode *N) { llvm_unreachable("visitFP_ROUND Unimplemented visit..."); return NULL; }
-Value* IREmitter::visitFP_ROUND_INREG(const SDNode *N) { llvm_unreachable("visitFP_ROUND_INREG Unimplemented visit..."); return NULL; }
-Value* IREmitter::visitFP_EXTEND(const SDNode *N) { llvm_unreachable("visitFP_EXTEND Unimplemented visit..."); return NULL; }
-Value* IREmitter::visitFNEG(const SDNode *N) { llvm_unreachable("visitFNEG Unimplemented visit..."); return NULL; }
-Value* IREmitter::visitFABS(const SDNode *N) { llvm_unreachable("visitFABS Unimplemented visit..."); return NULL; }
-Value* IREmitter::visitFCEIL(const SDNode *N) { llvm_unreachable("visitFCEIL Unimplemented visit..."); return NULL; }
-Value* IREmitter::visitFTRUNC(const SDNode *N) { llvm_unreachable("visitFTRUNC Unimplemented visit..."); return NULL; }
-Value* IREmitter::visitFFLOOR(const SDNode *N) { llvm_unreachable("visitFFLOOR Unimplemented visit..."); return NULL; }
-Value* IREmitter::visitBRCOND(const SDNode *N) { llvm_unreachable("visitBRCOND Unimplemented visit..."); return NULL; }
+Value* IREmitter::visitSHL(const SDNode *N) { return visitUnhandled(N); }
+Value* IREmitter::visitSRA(const SDNode *N) { return visitUnhandled(N); }
+Value* IREmitter::visitSRL(const SDNode *N) { return visitUnhandled(N); }
+Value* IREmitter::visitCTLZ(const SDNode *N) { return visitUnhandled(N); }
+Value* IREmitter::visitCTLZ_ZERO_UNDEF(const SDNode *N) { return visitUnhandled(N); }
+Value* IREmitter::visitCTTZ(const SDNode *N) { return visitUnhandled(N); }
+Value* IREmitter::visitCTTZ_ZERO_UNDEF(const SDNode *N) { return visitUnhandled(N); }
+Value* IREmitter::visitCTPOP(const SDNode *N) { return visitUnhandled(N); }
+Value* IREmitter::visitSELECT(const SDNode *N) { return visitUnhandled(N); }
+Value* IREmitter::visitVSELECT(const SDNode *N) { return visitUnhandled(N); }
+Value* IREmitter::visitSELECT_CC(const SDNode *N) { return visitUnhandled(N); }
+Value* IREmitter::visitSETCC(const SDNode *N) { return visitUnhandled(N); }
+Value* IREmitter::visitSIGN_EXTEND(const SDNode *N) { return visitUnhandled(N); }
+Value* IREmitter::visitZERO_EXTEND(const SDNode *N) { return visitUnhandled(N); }
+Value* IREmitter::visitANY_EXTEND(const SDNode *N) { return visitUnhandled(N); }
+Value* IREmitter::visitSIGN_EXTEND_INREG(const SDNode *N) { return visitUnhandled(N); }
+Value* IREmitter::visitTRUNCATE(const SDNode *N) { return visitUnhandled(N); }
+Value* IREmitter::visitBITCAST(const SDNode *N) { return visitUnhandled(N); }
+Value* IREmitter::visitBUILD_PAIR(const SDNode *N) { return visitUnhandled(N); }
+Value* IREmitter::visitFADD(const SDNode *N) { return visitUnhandled(N); }
+Value* IREmitter::visitFSUB(const SDNode *N) { return visitUnhandled(N); }
+Value* IREmitter::visitFMUL(const SDNode *N) { return visitUnhandled(N); }
+Value* IREmitter::visitFMA(const SDNode *N) { return visitUnhandled(N); }
+Value* IREmitter::visitFDIV(const SDNode *N) { return visitUnhandled(N); }
+Value* IREmitter::visitFREM(const SDNode *N) { return visitUnhandled(N); }
+Value* IREmitter::visitFCOPYSIGN(const SDNode *N) { return visitUnhandled(N); }
+Value* IREmitter::visitSINT_TO_FP(const SDNode *N) { return visitUnhandled(N); }
+Value* IREmitter::visitUINT_TO_FP(const SDNode *N) { return visitUnhandled(N); }
+Value* IREmitter::visitFP_TO_SINT(const SDNode *N) { return visitUnhandled(N); }
+Value* IREmitter::visitFP_TO_UINT(const SDNode *N) { return visitUnhandled(N); }
+Value* IREmitter::visitFP_ROUND(const SDNode *N) { return visitUnhandled(N); }
+Value* IREmitter::visitFP_ROUND_INREG(const SDNode *N) { return visitUnhandled(N); }
+Value* IREmitter::visitFP_EXTEND(const SDNode *N) { return visitUnhandled(N); }
+Value* IREmitter::visitFNEG(const SDNode *N) { return visitUnhandled(N); }
+Value* IREmitter::visitFABS(const SDNode *N) { return visitUnhandled(N); }
+Value* IREmitter::visitFCEIL(const SDNode *N) { return visitUnhandled(N); }
+Value* IREmitter::visitFTRUNC(const SDNode *N) { return visitUnhandled(N); }
+Value* IREmitter::visitFFLOOR(const SDNode *N) { return visitUnhandled(N); }
+Value* IREmitter::visitBRCOND(const SDNode *N) { return visitUnhandled(N); }
 
 Value* IREmitter::visitBR(const SDNode *N) {
   //llvm_unreachable("Unimplemented visit..."); return NULL;
@@ -484,7 +670,7 @@ Value* IREmitter::visitBR(const SDNode *N) {
     return Br;
 }
 
-Value* IREmitter::visitBR_CC(const SDNode *N) { llvm_unreachable("visitBR_CC Unimplemented visit..."); return NULL; }
+Value* IREmitter::visitBR_CC(const SDNode *N) { return visitUnhandled(N); }
 
 Value* IREmitter::visitLOAD(const SDNode *N) { 
   // Operand 0 - Addr to load, should be a pointer
@@ -533,12 +719,12 @@ Value* IREmitter::visitSTORE(const SDNode *N) {
   return Res;
 }
 
-Value* IREmitter::visitINSERT_VECTOR_ELT(const SDNode *N) { llvm_unreachable("visitINSERT_VECTOR_ELT Unimplemented visit..."); return NULL; }
-Value* IREmitter::visitEXTRACT_VECTOR_ELT(const SDNode *N) { llvm_unreachable("visitEXTRACT_VECTOR_ELT Unimplemented visit..."); return NULL; }
-Value* IREmitter::visitBUILD_VECTOR(const SDNode *N) { llvm_unreachable("visitBUILD_VECTOR Unimplemented visit..."); return NULL; }
-Value* IREmitter::visitCONCAT_VECTORS(const SDNode *N) { llvm_unreachable("visitCONCAT_VECTORS Unimplemented visit..."); return NULL; }
-Value* IREmitter::visitEXTRACT_SUBVECTOR(const SDNode *N) { llvm_unreachable("visitEXTRACT_SUBVECTOR Unimplemented visit..."); return NULL; }
-Value* IREmitter::visitVECTOR_SHUFFLE(const SDNode *N) { llvm_unreachable("visitVECTOR_SHUFFLE Unimplemented visit..."); return NULL; }
+Value* IREmitter::visitINSERT_VECTOR_ELT(const SDNode *N) { return visitUnhandled(N); }
+Value* IREmitter::visitEXTRACT_VECTOR_ELT(const SDNode *N) { return visitUnhandled(N); }
+Value* IREmitter::visitBUILD_VECTOR(const SDNode *N) { return visitUnhandled(N); }
+Value* IREmitter::visitCONCAT_VECTORS(const SDNode *N) { return visitUnhandled(N); }
+Value* IREmitter::visitEXTRACT_SUBVECTOR(const SDNode *N) { return visitUnhandled(N); }
+Value* IREmitter::visitVECTOR_SHUFFLE(const SDNode *N) { return visitUnhandled(N); }
 
 Value* IREmitter::visitRegister(const SDNode *N) {
   const RegisterSDNode *R = dyn_cast<RegisterSDNode>(N);
@@ -15,9 +15,12 @@
 //===----------------------------------------------------------------------===//
 
 #include "CodeInv/InvISelDAG.h"
+#include "CodeInv/Decompiler.h"
+#include "CodeInv/Metrics.h"
 #include "Target/ARM/ARMInvISelDAG.h"
 #include "Target/X86/X86InvISelDAG.h"
 #include "Target/PowerPC/PPCInvISelDAG.h"
+#include "llvm/ADT/Triple.h"
 #include "llvm/IR/DataLayout.h"
 
 //#include "StringRef.h"
@@ -61,6 +64,8 @@ InvISelDAG::InvISelDAG(const TargetMachine &TMC,
 // STATISTIC(NumFastIselBlocks, "Number of blocks selected entirely by fast isel");
 // STATISTIC(NumDAGBlocks, "Number of blocks selected using DAG");
 STATISTIC(NumDAGIselRetries,"Number of times dag isel has to try another path");
+STATISTIC(NumDAGIselNodes, "Number of nodes run through the inverse matcher");
+STATISTIC(NumDAGIselMisses, "Number of nodes that missed on the first scope");
 
 
 /// GetVBR - decode a vbr encoding whose top bit is set.
@@ -641,6 +646,8 @@ SDNode* InvISelDAG::InvertCodeCommon(SDNode *NodeToMatch,
   }
 
   assert(NodeToMatch->isMachineOpcode() && "Node already selected!");
+  ++NumDAGIselNodes;
+  bool MissedFirstScope = false;
 
   // Set up the node stack with NodeToMatch as the only node on the stack.
   SmallVector<SDValue, 8> NodeStack;
@@ -750,6 +757,7 @@ SDNode* InvISelDAG::InvertCodeCommon(SDNode *NodeToMatch,
         }
 
         FailIndex = MatcherIndex+NumToSkip;
+        Metrics::get().count(Metrics::MatcherScopesTried);
 
         unsigned MatcherIndexOfPredicate = MatcherIndex;
         (void)MatcherIndexOfPredicate; // silence warning.
@@ -767,6 +775,11 @@ SDNode* InvISelDAG::InvertCodeCommon(SDNode *NodeToMatch,
                      << "index " << MatcherIndexOfPredicate
                      << ", continuing at " << FailIndex << "\n");
         ++NumDAGIselRetries;
+        Metrics::get().count(Metrics::MatcherScopesFailed);
+        if (!MissedFirstScope) {
+          MissedFirstScope = true;
+          ++NumDAGIselMisses;
+        }
 
         // Otherwise, we know that this case of the Scope is guaranteed to fail,
         // move to the next case.
@@ -1411,6 +1424,11 @@ SDNode* InvISelDAG::InvertCodeCommon(SDNode *NodeToMatch,
     // find a case to check.
     DEBUG(errs() << "  Match failed at index " << CurrentOpcodeIndex << "\n");
     ++NumDAGIselRetries;
+    Metrics::get().count(Metrics::MatcherScopesFailed);
+    if (!MissedFirstScope) {
+      MissedFirstScope = true;
+      ++NumDAGIselMisses;
+    }
     while (1) {
       if (MatchScopes.empty()) {
         CannotYetSelect(NodeToMatch);
@@ -1449,6 +1467,7 @@ SDNode* InvISelDAG::InvertCodeCommon(SDNode *NodeToMatch,
       // try it.
       if (NumToSkip != 0) {
         LastScope.FailIndex = MatcherIndex+NumToSkip;
+        Metrics::get().count(Metrics::MatcherScopesTried);
         break;
       }
 
@@ -1574,10 +1593,23 @@ void InvISelDAG::SelectInlineAsmMemoryOperands(std::vector<SDValue> &Ops) {
 }
 
 void InvISelDAG::CannotYetSelect(SDNode *N) {
+  // In coverage mode the node is left as is; the emitter records it and
+  // replaces it with a placeholder.
+  if (Dec != NULL && Dec->getCoverageProfile() != NULL)
+    return;
+
   std::string msg;
   raw_string_ostream Msg(msg);
   Msg << "Cannot select: ";
 
+  // Count it before report_fatal_error, whose handler may exit.
+  std::string OpName = N->isMachineOpcode()
+    ? std::string(TM->getSubtargetImpl()->getInstrInfo()->getName(
+        N->getMachineOpcode()))
+    : N->getOperationName(CurDAG);
+  Triple TT(TM->getTargetTriple());
+  Metrics::get().countUnhandled(Triple::getArchTypeName(TT.getArch()), OpName);
+
   if (N->getOpcode() != ISD::INTRINSIC_W_CHAIN &&
       N->getOpcode() != ISD::INTRINSIC_WO_CHAIN &&
       N->getOpcode() != ISD::INTRINSIC_VOID) {
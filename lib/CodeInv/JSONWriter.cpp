@@ -0,0 +1,33 @@
+//===--- JSONWriter - Helpers for the JSON reports --------------*- C++ -*-===//
+//
+//              Fracture: The Draper Decompiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "CodeInv/JSONWriter.h"
+#include "llvm/Support/Format.h"
+
+using namespace llvm;
+
+namespace fracture {
+
+void writeJSONString(raw_ostream &Out, StringRef Str) {
+  Out << '"';
+  for (unsigned i = 0, e = Str.size(); i != e; ++i) {
+    unsigned char C = Str[i];
+    if (C == '"' || C == '\\')
+      Out << '\\' << C;
+    else if (C == '\n')
+      Out << "\\n";
+    else if (C < 0x20)
+      Out << format("\\u%04x", C);
+    else
+      Out << C;
+  }
+  Out << '"';
+}
+
+} // end namespace fracture
@@ -63,12 +63,6 @@ MCDirector::MCDirector(std::string TripleName,
     printError("Unable to create SubtargetInfo.");
   }
 
-  // MCDisassembler
-  DisAsm = TheTarget->createMCDisassembler(*STI, *MCCtx);
-  if (DisAsm == NULL) {
-    printError("Unable to create MCDisassembler.");
-  }
-
   // MCRegisterInfo
   MRI = TheTarget->createMCRegInfo(TripleName);
   if (MRI == NULL) {
@@ -91,6 +85,12 @@ MCDirector::MCDirector(std::string TripleName,
   // for MCObjectFileInfo
   MCOFI->InitMCObjectFileInfo(TripleName, RM, CM, *MCCtx);
 
+  // MCDisassembler
+  DisAsm = TheTarget->createMCDisassembler(*STI, *MCCtx);
+  if (DisAsm == NULL) {
+    printError("Unable to create MCDisassembler.");
+  }
+
   // MCInstrInfo
   MII = TheTarget->createMCInstrInfo();
   if (MII == NULL) {
@@ -104,21 +104,32 @@ MCDirector::MCDirector(std::string TripleName,
     printError("No instruction printer for target.");
   }
   MIP->setPrintImmHex(1);
+
+  // MCInstrAnalysis (falls back to the generic one if the target has none)
+  MIA = TheTarget->createMCInstrAnalysis(MII);
+  if (MIA == NULL) {
+    printError("No instruction analysis for target.");
+  }
+
+  if (TM != NULL && MRI != NULL) {
+    initRegTable();
+  }
 }
 
 MCDirector::~MCDirector() {
+  delete MIA;
   delete MIP;
   delete MII;
+  delete DisAsm;
   delete AsmInfo;
   delete MCCtx;
   delete MCOFI;
   delete MRI;
-  delete DisAsm;
   delete STI;
   delete TM;
-  delete TheTarget;
+  // NOTE: TheTarget belongs to the TargetRegistry and LLVMCtx is the global
+  // context, neither is ours to delete.
   delete TOpts;
-  delete LLVMCtx;
 }
 
 bool MCDirector::isValid() {
@@ -126,32 +137,133 @@ bool MCDirector::isValid() {
           && MII && MIP);
 }
 
-EVT MCDirector::getRegType(unsigned RegisterID) {
+void MCDirector::initRegTable() {
   const TargetRegisterInfo *TRI = TM->getSubtargetImpl()->getRegisterInfo();
-  if (RegTypes.size() == 0) {
-    RegTypes.grow(TRI->getNumRegs());
-  }
-  EVT NullEVT;
-  // Add to the map if it's not already there
-  if (RegTypes[RegisterID] == NullEVT) {
-    // Get the minimum physical subreg class
-    const TargetRegisterClass* MinRC = NULL;
-    for (TargetRegisterInfo::regclass_iterator TRS =
-           TRI->regclass_begin(), TRE = TRI->regclass_end(); TRS != TRE;
-         ++TRS) {
-      const TargetRegisterClass *RC = *TRS;
-      if (RC->contains(RegisterID) && (!MinRC || MinRC->hasSubClass(RC))) {
+  const TargetLowering *TLI = TM->getSubtargetImpl()->getTargetLowering();
+  unsigned NumRegs = TRI->getNumRegs();
+
+  RegisterEntry NullEntry;
+  NullEntry.Width = 0;
+  NullEntry.SuperReg = 0;
+  NullEntry.isPC = NullEntry.isSP = NullEntry.isFlags = NullEntry.isRA = false;
+  RegTable.grow(NumRegs - 1);
+  for (unsigned Reg = 0; Reg != NumRegs; ++Reg) {
+    RegTable[Reg] = NullEntry;
+    RegTable[Reg].SuperReg = Reg;
+  }
+
+  // Get the minimum physical subreg class of each register. Walking the
+  // classes once is much cheaper than searching them for every register.
+  std::vector<const TargetRegisterClass*> MinRCs(NumRegs, NULL);
+  for (TargetRegisterInfo::regclass_iterator TRS = TRI->regclass_begin(),
+         TRE = TRI->regclass_end(); TRS != TRE; ++TRS) {
+    const TargetRegisterClass *RC = *TRS;
+    for (TargetRegisterClass::iterator RI = RC->begin(), RE = RC->end();
+         RI != RE; ++RI) {
+      const TargetRegisterClass *&MinRC = MinRCs[*RI];
+      if (!MinRC || MinRC->hasSubClass(RC)) {
         MinRC = RC;
       }
     }
+  }
 
+  for (unsigned Reg = 0; Reg != NumRegs; ++Reg) {
+    RegisterEntry &Entry = RegTable[Reg];
+    const TargetRegisterClass *MinRC = MinRCs[Reg];
     if (MinRC == NULL) {
       MinRC = *(TRI->regclass_begin());
+    } else {
+      Entry.Width = MinRC->getSize() * 8;
+      // Registers that cannot be copied are the condition code registers
+      // (CPSR on ARM, EFLAGS on X86, CARRY on PowerPC).
+      Entry.isFlags = (MinRC->getCopyCost() < 0);
+    }
+    Entry.Type = *(MinRC->vt_begin());
+
+    if (Reg == 0) {
+      continue;
     }
+    for (MCSuperRegIterator SR(Reg, MRI); SR.isValid(); ++SR) {
+      if (!MCSuperRegIterator(*SR, MRI).isValid()) {
+        Entry.SuperReg = *SR;
+        break;
+      }
+    }
+  }
+
+  // Mark the special registers along with all of their aliases, so that
+  // e.g. ESP and SP are stack pointers as well as RSP.
+  unsigned SPReg = TLI ? TLI->getStackPointerRegisterToSaveRestore() : 0;
+  if (SPReg) {
+    for (MCRegAliasIterator AI(SPReg, MRI, true); AI.isValid(); ++AI) {
+      RegTable[*AI].isSP = true;
+    }
+  }
+  unsigned PCReg = MRI->getProgramCounter();
+  if (PCReg) {
+    for (MCRegAliasIterator AI(PCReg, MRI, true); AI.isValid(); ++AI) {
+      RegTable[*AI].isPC = true;
+    }
+  }
+  unsigned RAReg = MRI->getRARegister();
+  if (RAReg && !RegTable[RAReg].isPC) {
+    for (MCRegAliasIterator AI(RAReg, MRI, true); AI.isValid(); ++AI) {
+      RegTable[*AI].isRA = true;
+    }
+  }
+}
+
+EVT MCDirector::getImmType(const MCInstrDesc &Desc, unsigned OpIdx) {
+  const TargetRegisterInfo *TRI = TM->getSubtargetImpl()->getRegisterInfo();
+  const DataLayout *DL = TM->getSubtargetImpl()->getDataLayout();
+  EVT PtrVT = EVT(MVT::i32);
+  if (DL != NULL) {
+    PtrVT = EVT(MVT::getIntegerVT(DL->getPointerSizeInBits()));
+  }
+
+  // Variadic operands carry no operand info.
+  if (OpIdx >= Desc.getNumOperands()) {
+    return PtrVT;
+  }
+
+  const MCOperandInfo &OpInfo = Desc.OpInfo[OpIdx];
+  // Condition codes and the like are always matched as i32.
+  if (OpInfo.isPredicate() || OpInfo.isOptionalDef()) {
+    return EVT(MVT::i32);
+  }
+  switch (OpInfo.OperandType) {
+    case MCOI::OPERAND_PCREL:
+      return PtrVT;
+    case MCOI::OPERAND_MEMORY:
+      // Addressing mode displacements are emitted as i32 by the targets'
+      // complex patterns.
+      return EVT(MVT::i32);
+    default:
+      break;
+  }
+
+  // Arithmetic immediates take the width of the first integer register
+  // operand. Defs come first, so e.g. MOV64ri and ADDI8 pick up i64.
+  EVT ImmVT;
+  for (unsigned i = 0, e = Desc.getNumOperands(); i != e; ++i) {
+    const MCOperandInfo &RegInfo = Desc.OpInfo[i];
+    if (RegInfo.RegClass < 0 || RegInfo.OperandType == MCOI::OPERAND_MEMORY
+      || RegInfo.isPredicate() || RegInfo.isOptionalDef()) {
+      continue;
+    }
+    const TargetRegisterClass *RC = TRI->getRegClass(RegInfo.RegClass);
+    EVT RegVT = *(RC->vt_begin());
+    if (!RegVT.isInteger()) {
+      continue;
+    }
+    ImmVT = RegVT;
+    break;
+  }
 
-    RegTypes[RegisterID] = *(MinRC->vt_begin());
+  if (ImmVT == EVT()) {
+    return EVT(MVT::i32);
   }
-  return RegTypes[RegisterID];
+  return ImmVT;
 }
 
 } // end namespace fracture
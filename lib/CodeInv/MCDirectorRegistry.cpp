@@ -0,0 +1,61 @@
+//===--- MCDirectorRegistry - Cache of MCDirector objects -------*- C++ -*-===//
+//
+//              Fracture: The Draper Decompiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This class keeps one MCDirector per (triple, CPU, features) so that loading
+// several executables of the same architecture does not rebuild the target
+// machine and MC layer every time.
+//
+//===----------------------------------------------------------------------===//
+
+#include "CodeInv/MCDirectorRegistry.h"
+
+using namespace llvm;
+
+namespace fracture {
+
+MCDirectorRegistry::~MCDirectorRegistry() {
+  for (std::map<std::string, MCDirector*>::iterator I = Directors.begin(),
+         E = Directors.end(); I != E; ++I) {
+    delete I->second;
+  }
+}
+
+MCDirector* MCDirectorRegistry::getDirector(std::string TripleName,
+  StringRef CPUName,
+  StringRef Features,
+  TargetOptions TargetOpts,
+  Reloc::Model RM,
+  CodeModel::Model CM,
+  CodeGenOpt::Level OL) {
+  std::string Key = getKey(TripleName, CPUName, Features);
+  std::map<std::string, MCDirector*>::iterator It = Directors.find(Key);
+  if (It != Directors.end()) {
+    return It->second;
+  }
+
+  // NOTE: Invalid directors are kept too, the result would not change on a
+  // second try and callers are expected to check isValid().
+  MCDirector *MCD = new MCDirector(TripleName, CPUName, Features, TargetOpts,
+    RM, CM, OL, Infos, Errs);
+  Directors[Key] = MCD;
+  return MCD;
+}
+
+void MCDirectorRegistry::removeDirector(std::string TripleName,
+  StringRef CPUName, StringRef Features) {
+  std::map<std::string, MCDirector*>::iterator It =
+    Directors.find(getKey(TripleName, CPUName, Features));
+  if (It == Directors.end()) {
+    return;
+  }
+  delete It->second;
+  Directors.erase(It);
+}
+
+} // end namespace fracture
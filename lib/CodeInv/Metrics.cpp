@@ -0,0 +1,135 @@
+//===--- Metrics - Per stage timers and counters ----------------*- C++ -*-===//
+//
+//              Fracture: The Draper Decompiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Process wide timers and counters for the decompiler stages.
+//
+//===----------------------------------------------------------------------===//
+
+#include "CodeInv/Metrics.h"
+#include "CodeInv/JSONWriter.h"
+#include "llvm/Support/Format.h"
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+using namespace llvm;
+
+namespace fracture {
+
+Metrics& Metrics::get() {
+  static Metrics TheMetrics;
+  return TheMetrics;
+}
+
+double Metrics::now() {
+  using namespace std::chrono;
+  return duration<double>(steady_clock::now().time_since_epoch()).count();
+}
+
+const char* Metrics::getTimerName(TimerID T) {
+  switch (T) {
+    case DecodeTimer: return "decode";
+    case DAGBuildTimer: return "dag";
+    case InvertTimer: return "invert";
+    case EmitTimer: return "emit";
+    case OptTimer: return "opt";
+    case NumTimers: break;
+  }
+  return "unknown";
+}
+
+const char* Metrics::getCounterName(CounterID C) {
+  switch (C) {
+    case InstsDecoded: return "insts_decoded";
+    case DecodeFailures: return "decode_failures";
+    case DAGNodesCreated: return "dag_nodes_created";
+    case DAGNodesInverted: return "dag_nodes_inverted";
+    case MatcherScopesTried: return "matcher_scopes_tried";
+    case MatcherScopesFailed: return "matcher_scopes_failed";
+    case FunctionsEvicted: return "functions_evicted";
+    case NumCounters: break;
+  }
+  return "unknown";
+}
+
+void Metrics::countUnhandled(StringRef Target, StringRef Opcode) {
+  ++Unhandled[Target][Opcode];
+}
+
+void Metrics::reset() {
+  std::fill(Times, Times + NumTimers, 0.0);
+  std::fill(Calls, Calls + NumTimers, 0);
+  std::fill(Counters, Counters + NumCounters, 0);
+  Unhandled.clear();
+}
+
+/// Sorted keys of a StringMap, so output does not depend on hash order.
+template <typename T>
+static std::vector<StringRef> getSortedKeys(const StringMap<T> &Map) {
+  std::vector<StringRef> Keys;
+  for (typename StringMap<T>::const_iterator I = Map.begin(), E = Map.end();
+       I != E; ++I)
+    Keys.push_back(I->getKey());
+  std::sort(Keys.begin(), Keys.end());
+  return Keys;
+}
+
+void Metrics::print(raw_ostream &Out) const {
+  Out << "--TIMERS--\n";
+  for (unsigned T = 0; T != NumTimers; ++T)
+    Out << format("  %-24s %10.6fs %10llu calls\n", getTimerName(TimerID(T)),
+      Times[T], (unsigned long long)Calls[T]);
+  Out << "--COUNTERS--\n";
+  for (unsigned C = 0; C != NumCounters; ++C)
+    Out << format("  %-24s %10llu\n", getCounterName(CounterID(C)),
+      (unsigned long long)Counters[C]);
+  if (Unhandled.empty())
+    return;
+  Out << "--UNHANDLED OPCODES--\n";
+  std::vector<StringRef> Targets = getSortedKeys(Unhandled);
+  for (unsigned i = 0, e = Targets.size(); i != e; ++i) {
+    const StringMap<uint64_t> &Opcodes = Unhandled.find(Targets[i])->getValue();
+    std::vector<StringRef> Names = getSortedKeys(Opcodes);
+    for (unsigned j = 0, je = Names.size(); j != je; ++j)
+      Out << "  " << Targets[i] << " " << Names[j] << "\t"
+          << Opcodes.find(Names[j])->getValue() << "\n";
+  }
+}
+
+void Metrics::writeJSON(raw_ostream &Out) const {
+  Out << "{ \"timers\": {";
+  for (unsigned T = 0; T != NumTimers; ++T)
+    Out << (T ? ", " : " ") << "\"" << getTimerName(TimerID(T))
+        << "\": { \"seconds\": " << format("%.6f", Times[T])
+        << ", \"calls\": " << Calls[T] << " }";
+  Out << " }, \"counters\": {";
+  for (unsigned C = 0; C != NumCounters; ++C)
+    Out << (C ? ", " : " ") << "\"" << getCounterName(CounterID(C)) << "\": "
+        << Counters[C];
+  Out << " }, \"unhandled\": {";
+  std::vector<StringRef> Targets = getSortedKeys(Unhandled);
+  for (unsigned i = 0, e = Targets.size(); i != e; ++i) {
+    Out << (i ? ", " : " ");
+    writeJSONString(Out, Targets[i]);
+    Out << ": {";
+    const StringMap<uint64_t> &Opcodes = Unhandled.find(Targets[i])->getValue();
+    std::vector<StringRef> Names = getSortedKeys(Opcodes);
+    for (unsigned j = 0, je = Names.size(); j != je; ++j) {
+      Out << (j ? ", " : " ");
+      writeJSONString(Out, Names[j]);
+      Out << ": " << Opcodes.find(Names[j])->getValue();
+    }
+    Out << " }";
+  }
+  Out << " } }";
+}
+
+} // end namespace fracture
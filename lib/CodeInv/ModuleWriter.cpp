@@ -0,0 +1,98 @@
+//===--- ModuleWriter - Writes decompiled modules ---------------*- C++ -*-===//
+//
+//              Fracture: The Draper Decompiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Writes decompiled modules as textual IR or bitcode.
+//
+//===----------------------------------------------------------------------===//
+
+#include "CodeInv/ModuleWriter.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Bitcode/ReaderWriter.h"
+#include "llvm/IR/GlobalVariable.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Transforms/Utils/Cloning.h"
+
+#include <memory>
+
+using namespace llvm;
+
+namespace fracture {
+
+OutputFormat getOutputFormat(StringRef FileName) {
+  return sys::path::extension(FileName) == ".bc" ? Bitcode : TextIR;
+}
+
+std::error_code writeModule(const Module &M, StringRef FileName,
+  OutputFormat Format) {
+  std::error_code EC;
+  raw_fd_ostream Out(FileName, EC,
+    Format == Bitcode ? sys::fs::F_None : sys::fs::F_Text);
+  if (EC)
+    return EC;
+  if (Format == Bitcode)
+    WriteBitcodeToFile(&M, Out);
+  else
+    Out << M;
+  return std::error_code();
+}
+
+FunctionStreamer::FunctionStreamer(StringRef NewDirectory,
+  OutputFormat NewFormat) : Directory(NewDirectory), Format(NewFormat),
+  NumWritten(0) {}
+
+std::string FunctionStreamer::getFileName(StringRef Name) const {
+  // Symbol names can hold anything; keep the file names portable. The
+  // number keeps them unique and in decompile order.
+  std::string Base;
+  raw_string_ostream BaseOut(Base);
+  BaseOut << format("%05u-", NumWritten);
+  for (unsigned i = 0, e = Name.size(); i != e; ++i) {
+    char C = Name[i];
+    bool Plain = (C >= 'a' && C <= 'z') || (C >= 'A' && C <= 'Z')
+      || (C >= '0' && C <= '9') || C == '_' || C == '.' || C == '$';
+    BaseOut << (Plain ? C : '_');
+  }
+  BaseOut << (Format == Bitcode ? ".bc" : ".ll");
+  BaseOut.flush();
+
+  SmallString<128> Path(Directory);
+  sys::path::append(Path, Base);
+  return Path.str();
+}
+
+std::error_code FunctionStreamer::writeFunction(Function *F) {
+  // Write a copy in which F is the only definition: the other functions
+  // still in the module and every global are declarations, so the files of
+  // the directory link without clashing.
+  ValueToValueMapTy VMap;
+  std::unique_ptr<Module> Copy(CloneModule(F->getParent(), VMap));
+  Value *CopyOfF = VMap[F];
+  for (Module::iterator FI = Copy->begin(), FE = Copy->end(); FI != FE; ++FI)
+    if (&*FI != CopyOfF && !FI->isDeclaration())
+      FI->deleteBody();
+  for (Module::global_iterator GI = Copy->global_begin(),
+         GE = Copy->global_end(); GI != GE; ++GI)
+    GI->setInitializer(NULL);
+
+  std::error_code EC = writeModule(*Copy, getFileName(F->getName()), Format);
+  if (!EC)
+    ++NumWritten;
+  return EC;
+}
+
+std::error_code FunctionStreamer::finish(const Module &M) {
+  SmallString<128> Path(Directory);
+  sys::path::append(Path, Format == Bitcode ? "globals.bc" : "globals.ll");
+  return writeModule(M, Path, Format);
+}
+
+} // end namespace fracture
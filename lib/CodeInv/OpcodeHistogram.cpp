@@ -0,0 +1,155 @@
+//===--- OpcodeHistogram - Instruction frequency counts ---------*- C++ -*-===//
+//
+//              Fracture: The Draper Decompiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Counts how often each opcode is seen, and saves and merges the counts.
+//
+// Saved format (all integers little endian):
+//   "FRHIST01", u32 number of entries,
+//   per entry: u32 name length, name bytes, u64 count.
+//
+//===----------------------------------------------------------------------===//
+
+#include "CodeInv/OpcodeHistogram.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+
+#include <algorithm>
+
+using namespace llvm;
+
+namespace fracture {
+
+static const char HistogramMagic[] = "FRHIST01";
+static const unsigned HistogramMagicSize = 8;
+
+OpcodeHistogram::OpcodeHistogram(const MCInstrInfo *TheMII) : MII(TheMII),
+  Counts(TheMII->getNumOpcodes(), 0), Total(0) {}
+
+void OpcodeHistogram::merge(const OpcodeHistogram &Other) {
+  if (MII != NULL && MII == Other.MII) {
+    for (unsigned i = 0, e = Counts.size(); i != e; ++i)
+      Counts[i] += Other.Counts[i];
+    for (StringMap<uint64_t>::const_iterator I = Other.NamedCounts.begin(),
+           E = Other.NamedCounts.end(); I != E; ++I)
+      NamedCounts[I->getKey()] += I->getValue();
+    Total += Other.Total;
+    return;
+  }
+
+  Other.getEntries(NamedCounts);
+  Total += Other.Total;
+}
+
+uint64_t OpcodeHistogram::getCount(StringRef Name) const {
+  uint64_t Count = 0;
+  StringMap<uint64_t>::const_iterator It = NamedCounts.find(Name);
+  if (It != NamedCounts.end())
+    Count = It->getValue();
+  if (MII != NULL)
+    for (unsigned i = 0, e = Counts.size(); i != e; ++i)
+      if (Counts[i] != 0 && Name == MII->getName(i))
+        Count += Counts[i];
+  return Count;
+}
+
+void OpcodeHistogram::getEntries(StringMap<uint64_t> &Entries) const {
+  for (StringMap<uint64_t>::const_iterator I = NamedCounts.begin(),
+         E = NamedCounts.end(); I != E; ++I)
+    Entries[I->getKey()] += I->getValue();
+  if (MII != NULL)
+    for (unsigned i = 0, e = Counts.size(); i != e; ++i)
+      if (Counts[i] != 0)
+        Entries[MII->getName(i)] += Counts[i];
+}
+
+static bool compareEntries(const std::pair<StringRef, uint64_t> &A,
+  const std::pair<StringRef, uint64_t> &B) {
+  if (A.second != B.second)
+    return A.second > B.second;
+  return A.first < B.first;
+}
+
+void OpcodeHistogram::print(raw_ostream &Out) const {
+  StringMap<uint64_t> Merged;
+  getEntries(Merged);
+  std::vector<std::pair<StringRef, uint64_t> > Entries;
+  for (StringMap<uint64_t>::const_iterator I = Merged.begin(),
+         E = Merged.end(); I != E; ++I)
+    Entries.push_back(std::make_pair(I->getKey(), I->getValue()));
+  std::sort(Entries.begin(), Entries.end(), compareEntries);
+  for (unsigned i = 0, e = Entries.size(); i != e; ++i)
+    Out << Entries[i].first << "\t" << Entries[i].second << "\n";
+}
+
+static void writeLE(raw_ostream &Out, uint64_t Value, unsigned Size) {
+  for (unsigned i = 0; i != Size; ++i)
+    Out << (char)((Value >> (8 * i)) & 0xff);
+}
+
+static uint64_t readLE(const unsigned char *Data, unsigned Size) {
+  uint64_t Value = 0;
+  for (unsigned i = Size; i != 0; --i)
+    Value = (Value << 8) | Data[i - 1];
+  return Value;
+}
+
+std::error_code OpcodeHistogram::write(StringRef FileName) const {
+  std::error_code EC;
+  raw_fd_ostream Out(FileName, EC, sys::fs::F_None);
+  if (EC)
+    return EC;
+
+  StringMap<uint64_t> Entries;
+  getEntries(Entries);
+  Out.write(HistogramMagic, HistogramMagicSize);
+  writeLE(Out, Entries.size(), 4);
+  for (StringMap<uint64_t>::const_iterator I = Entries.begin(),
+         E = Entries.end(); I != E; ++I) {
+    writeLE(Out, I->getKey().size(), 4);
+    Out << I->getKey();
+    writeLE(Out, I->getValue(), 8);
+  }
+  return std::error_code();
+}
+
+std::error_code OpcodeHistogram::read(StringRef FileName) {
+  ErrorOr<std::unique_ptr<MemoryBuffer> > Buf = MemoryBuffer::getFile(FileName);
+  if (std::error_code EC = Buf.getError())
+    return EC;
+
+  StringRef Data = Buf.get()->getBuffer();
+  const unsigned char *Ptr = (const unsigned char*)Data.data();
+  const unsigned char *End = Ptr + Data.size();
+  std::error_code Malformed =
+    std::make_error_code(std::errc::illegal_byte_sequence);
+  if (!Data.startswith(StringRef(HistogramMagic, HistogramMagicSize))
+    || Data.size() < HistogramMagicSize + 4)
+    return Malformed;
+  Ptr += HistogramMagicSize;
+  uint64_t NumEntries = readLE(Ptr, 4);
+  Ptr += 4;
+
+  for (uint64_t i = 0; i != NumEntries; ++i) {
+    if (End - Ptr < 4)
+      return Malformed;
+    uint64_t NameSize = readLE(Ptr, 4);
+    Ptr += 4;
+    if ((uint64_t)(End - Ptr) < NameSize + 8)
+      return Malformed;
+    StringRef Name((const char*)Ptr, NameSize);
+    Ptr += NameSize;
+    uint64_t Count = readLE(Ptr, 8);
+    Ptr += 8;
+    NamedCounts[Name] += Count;
+    Total += Count;
+  }
+  return std::error_code();
+}
+
+} // end namespace fracture
@@ -0,0 +1,89 @@
+//===--- OptPipeline - Passes run over decompiled functions -----*- C++ -*-===//
+//
+//              Fracture: The Draper Decompiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Builds and runs the function pass pipeline applied to decompiled functions.
+//
+//===----------------------------------------------------------------------===//
+
+#include "CodeInv/OptPipeline.h"
+#include "CodeInv/Metrics.h"
+#include "Transforms/TypeRecovery.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Transforms/Scalar.h"
+
+using namespace llvm;
+
+namespace fracture {
+
+const char *OptPipeline::DefaultPasses = "mem2reg,instcombine,simplifycfg,dce";
+
+OptPipeline::~OptPipeline() {
+  delete FPM;
+}
+
+Pass* OptPipeline::createPass(StringRef Name) {
+  if (Name == "mem2reg") return createPromoteMemoryToRegisterPass();
+  if (Name == "sroa") return createSROAPass();
+  if (Name == "instcombine") return createInstructionCombiningPass();
+  if (Name == "simplifycfg") return createCFGSimplificationPass();
+  if (Name == "early-cse") return createEarlyCSEPass();
+  if (Name == "gvn") return createGVNPass();
+  if (Name == "dce") return createDeadCodeEliminationPass();
+  if (Name == "adce") return createAggressiveDCEPass();
+  if (Name == "typerecovery") return createTypeRecoveryPass();
+  return NULL;
+}
+
+bool OptPipeline::parse(StringRef Passes, std::string &Error) {
+  SmallVector<StringRef, 8> Names;
+  Passes.split(Names, ",");
+  std::vector<std::string> NewNames;
+  for (unsigned i = 0, e = Names.size(); i != e; ++i) {
+    StringRef Name = Names[i].trim();
+    if (Name.empty())
+      continue;
+    // Check the name now, so a typo does not show up in the middle of a run.
+    Pass *P = createPass(Name);
+    if (P == NULL) {
+      Error = "unknown pass '" + Name.str() + "'";
+      return false;
+    }
+    delete P;
+    NewNames.push_back(Name);
+  }
+  PassNames.swap(NewNames);
+  // Rebuilt with the new passes on the next run.
+  reset();
+  return true;
+}
+
+void OptPipeline::reset() {
+  delete FPM;
+  FPM = NULL;
+  FPMModule = NULL;
+}
+
+bool OptPipeline::run(Function &F) {
+  if (PassNames.empty() || F.isDeclaration())
+    return false;
+  Metrics::Scope Timer(Metrics::OptTimer);
+
+  Module *M = F.getParent();
+  if (FPM == NULL || FPMModule != M) {
+    delete FPM;
+    FPM = new FunctionPassManager(M);
+    for (unsigned i = 0, e = PassNames.size(); i != e; ++i)
+      FPM->add(createPass(PassNames[i]));
+    FPM->doInitialization();
+    FPMModule = M;
+  }
+  return FPM->run(F);
+}
+
+} // end namespace fracture
@@ -0,0 +1,156 @@
+//===--- PrologueScanner - Raw byte function start scanner ------*- C++ -*-===//
+//
+//              Fracture: The Draper Decompiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Finds likely function starts in raw section bytes.
+//
+//===----------------------------------------------------------------------===//
+
+#include "CodeInv/PrologueScanner.h"
+#include "llvm/ADT/Triple.h"
+#include "llvm/Support/MathExtras.h"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace llvm;
+
+namespace fracture {
+
+namespace {
+
+struct PatternDesc {
+  Triple::ArchType Arch;
+  const char *Bytes;
+  const char *Mask;   // NULL when every bit of Bytes must match.
+  unsigned Len;
+  unsigned Align;
+};
+
+const PatternDesc PatternTable[] = {
+  // push ebp; mov ebp, esp (both encodings of the mov)
+  { Triple::x86, "\x55\x89\xe5", nullptr, 3, 1 },
+  { Triple::x86, "\x55\x8b\xec", nullptr, 3, 1 },
+  // endbr32
+  { Triple::x86, "\xf3\x0f\x1e\xfb", nullptr, 4, 1 },
+  // push rbp; mov rbp, rsp
+  { Triple::x86_64, "\x55\x48\x89\xe5", nullptr, 4, 1 },
+  { Triple::x86_64, "\x55\x48\x8b\xec", nullptr, 4, 1 },
+  // endbr64
+  { Triple::x86_64, "\xf3\x0f\x1e\xfa", nullptr, 4, 1 },
+  // stmdb sp!, {..., lr}
+  { Triple::arm, "\x00\x40\x2d\xe9", "\x00\x40\xff\xff", 4, 4 },
+  // push {..., lr}
+  { Triple::thumb, "\x00\xb5", "\x00\xff", 2, 2 },
+  // push.w {..., lr}
+  { Triple::thumb, "\x2d\xe9\x00\x40", "\xff\xff\x00\x40", 4, 2 }
+};
+
+} // end anonymous namespace
+
+PrologueScanner::PrologueScanner(StringRef TripleName) : FilterLen(0) {
+  Triple::ArchType Arch = Triple(TripleName).getArch();
+  for (const PatternDesc &D : PatternTable) {
+    if (D.Arch != Arch)
+      continue;
+    addPattern(StringRef(D.Bytes, D.Len),
+      D.Mask ? StringRef(D.Mask, D.Len) : StringRef(), D.Align);
+  }
+  buildFilter();
+}
+
+void PrologueScanner::addPattern(StringRef Bytes, StringRef Mask,
+  unsigned Align) {
+  Pattern P;
+  for (unsigned i = 0, e = Bytes.size(); i != e; ++i) {
+    uint8_t M = Mask.empty() ? 0xff : (uint8_t)Mask[i];
+    P.Bytes.push_back((uint8_t)Bytes[i] & M);
+    P.Mask.push_back(M);
+  }
+  P.Align = Align;
+  Buckets[Patterns.size() % NumBuckets].push_back(Patterns.size());
+  Patterns.push_back(P);
+}
+
+void PrologueScanner::buildFilter() {
+  std::memset(LoMask, 0, sizeof(LoMask));
+  std::memset(HiMask, 0, sizeof(HiMask));
+  if (Patterns.empty())
+    return;
+
+  FilterLen = MaxFilterLen;
+  for (const Pattern &P : Patterns)
+    FilterLen = std::min(FilterLen, (unsigned)P.Bytes.size());
+
+  // A nibble value gets a pattern's bucket bit if it agrees with the pattern
+  // byte on every bit the mask cares about.
+  for (unsigned i = 0, e = Patterns.size(); i != e; ++i) {
+    uint8_t Bit = 1 << (i % NumBuckets);
+    const Pattern &P = Patterns[i];
+    for (unsigned k = 0; k != FilterLen; ++k)
+      for (unsigned N = 0; N != 16; ++N) {
+        if ((N & P.Mask[k] & 0xf) == (P.Bytes[k] & 0xf))
+          LoMask[k][N] |= Bit;
+        if ((N & (P.Mask[k] >> 4)) == (P.Bytes[k] >> 4))
+          HiMask[k][N] |= Bit;
+      }
+  }
+}
+
+bool PrologueScanner::matches(const Pattern &P, const uint8_t *Data,
+  uint64_t Address) const {
+  if (Address % P.Align != 0)
+    return false;
+  for (unsigned i = 0, e = P.Bytes.size(); i != e; ++i)
+    if ((Data[i] & P.Mask[i]) != P.Bytes[i])
+      return false;
+  return true;
+}
+
+void PrologueScanner::scan(ArrayRef<uint8_t> Bytes, uint64_t Base,
+  std::vector<uint64_t> &Starts) const {
+  if (Patterns.empty() || Bytes.size() < FilterLen)
+    return;
+
+  const uint8_t *Data = Bytes.data();
+  uint64_t Size = Bytes.size();
+  for (uint64_t Offset = 0, E = Size - FilterLen + 1; Offset != E; ++Offset) {
+    uint8_t Candidates = 0xff;
+    for (unsigned k = 0; k != FilterLen && Candidates; ++k) {
+      uint8_t B = Data[Offset + k];
+      Candidates &= LoMask[k][B & 0xf] & HiMask[k][B >> 4];
+    }
+
+    while (Candidates) {
+      unsigned Bucket = countTrailingZeros(Candidates);
+      Candidates &= Candidates - 1;
+      bool Found = false;
+      for (unsigned Idx : Buckets[Bucket]) {
+        const Pattern &P = Patterns[Idx];
+        if (Offset + P.Bytes.size() <= Size &&
+            matches(P, Data + Offset, Base + Offset)) {
+          Found = true;
+          break;
+        }
+      }
+      if (Found) {
+        Starts.push_back(Base + Offset);
+        break;
+      }
+    }
+  }
+}
+
+void PrologueScanner::scan(FractureMemoryObject &Mem,
+  std::vector<uint64_t> &Starts) const {
+  StringRef Bytes = Mem.getBytes();
+  scan(ArrayRef<uint8_t>((const uint8_t*)Bytes.data(), Bytes.size()),
+    Mem.getBase(), Starts);
+}
+
+} // end namespace fracture
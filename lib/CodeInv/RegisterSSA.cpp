@@ -0,0 +1,265 @@
+//===--- RegisterSSA - Puts machine registers into SSA form -----*- C++ -*-===//
+//
+//              Fracture: The Draper Decompiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Replaces the register global loads and stores of a function with SSA
+// values and phis.
+//
+//===----------------------------------------------------------------------===//
+
+#include "CodeInv/RegisterSSA.h"
+#include "llvm/ADT/PostOrderIterator.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/IR/CFG.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/IntrinsicInst.h"
+
+using namespace llvm;
+
+#define DEBUG_TYPE "register-ssa"
+
+STATISTIC(NumLoadsRemoved, "Number of register loads replaced by SSA values");
+STATISTIC(NumStoresRemoved, "Number of register stores removed");
+STATISTIC(NumPhisInserted, "Number of register phis left after cleanup");
+
+namespace fracture {
+
+bool RegisterSSA::run(Function &F) {
+  if (F.isDeclaration())
+    return false;
+
+  std::vector<GlobalVariable*> Regs;
+  getPromotable(F, Regs);
+  if (Regs.empty())
+    return false;
+
+  // Defs come before their uses in reverse post order, so every value kept
+  // in the maps is final when it is recorded. Unreachable blocks are left as
+  // they are.
+  ReversePostOrderTraversal<Function*> RPOT(&F);
+  for (ReversePostOrderTraversal<Function*>::rpo_iterator I = RPOT.begin(),
+         E = RPOT.end(); I != E; ++I)
+    rewriteBlock(*I, Regs);
+
+  // Fill the phis. Reading a predecessor that has no def of its own adds
+  // phis to the list.
+  for (unsigned i = 0; i != Incomplete.size(); ++i) {
+    GlobalVariable *Reg = Incomplete[i].first;
+    PHINode *Phi = Incomplete[i].second;
+    BasicBlock *BB = Phi->getParent();
+    for (pred_iterator PI = pred_begin(BB), PE = pred_end(BB); PI != PE; ++PI)
+      Phi->addIncoming(getEndDef(Reg, *PI), *PI);
+  }
+
+  for (unsigned i = 0, e = Phis.size(); i != e; ++i)
+    if (PHINode *Phi = dyn_cast_or_null<PHINode>(Phis[i]))
+      tryRemoveTrivialPhi(Phi);
+
+  // A write back of the value the register was last loaded with does not
+  // change it.
+  for (unsigned i = 0, e = WriteBacks.size(); i != e; ++i) {
+    StoreInst *SI = cast<StoreInst>(WriteBacks[i]);
+    LoadInst *LI = dyn_cast<LoadInst>(SI->getValueOperand());
+    if (LI != NULL && LI->getPointerOperand() == SI->getPointerOperand())
+      SI->eraseFromParent();
+  }
+  for (unsigned i = 0, e = Loads.size(); i != e; ++i) {
+    Instruction *LI = cast<Instruction>(Loads[i]);
+    if (LI->use_empty())
+      LI->eraseFromParent();
+  }
+  bool Changed = true;
+  while (Changed) {
+    Changed = false;
+    for (unsigned i = 0, e = Phis.size(); i != e; ++i) {
+      PHINode *Phi = dyn_cast_or_null<PHINode>(Phis[i]);
+      if (Phi != NULL && Phi->use_empty()) {
+        Phi->eraseFromParent();
+        Changed = true;
+      }
+    }
+  }
+  for (unsigned i = 0, e = Phis.size(); i != e; ++i) {
+    Value *Phi = Phis[i];
+    if (Phi != NULL)
+      ++NumPhisInserted;
+  }
+
+  EndDefs.clear();
+  EntryDefs.clear();
+  Incomplete.clear();
+  Phis.clear();
+  Loads.clear();
+  WriteBacks.clear();
+  return true;
+}
+
+void RegisterSSA::getPromotable(Function &F,
+  std::vector<GlobalVariable*> &Regs) {
+  SmallPtrSet<GlobalVariable*, 32> Seen;
+  for (Function::iterator BI = F.begin(), BE = F.end(); BI != BE; ++BI) {
+    for (BasicBlock::iterator I = BI->begin(), E = BI->end(); I != E; ++I) {
+      Value *Ptr = NULL;
+      if (LoadInst *LI = dyn_cast<LoadInst>(I))
+        Ptr = LI->getPointerOperand();
+      else if (StoreInst *SI = dyn_cast<StoreInst>(I))
+        Ptr = SI->getPointerOperand();
+      GlobalVariable *GV = dyn_cast_or_null<GlobalVariable>(Ptr);
+      if (GV == NULL || !Seen.insert(GV).second)
+        continue;
+
+      // Any other use in F, e.g. its address taken, keeps it in memory.
+      bool Promotable = true;
+      for (User *U : GV->users()) {
+        if (Instruction *UI = dyn_cast<Instruction>(U)) {
+          if (UI->getParent()->getParent() != &F)
+            continue;
+          if (LoadInst *UL = dyn_cast<LoadInst>(UI))
+            Promotable &= UL->isSimple();
+          else if (StoreInst *US = dyn_cast<StoreInst>(UI))
+            Promotable &= US->isSimple() && US->getPointerOperand() == GV
+              && US->getValueOperand() != GV;
+          else
+            Promotable = false;
+          continue;
+        }
+        for (User *CU : U->users())
+          if (Instruction *CI = dyn_cast<Instruction>(CU))
+            Promotable &= CI->getParent()->getParent() != &F;
+      }
+      if (Promotable)
+        Regs.push_back(GV);
+    }
+  }
+}
+
+Value* RegisterSSA::getEntryDef(GlobalVariable *Reg, BasicBlock *BB) {
+  Value *&Def = EntryDefs[std::make_pair(Reg, BB)];
+  if (Def != NULL)
+    return Def;
+
+  Instruction *First = BB->getFirstNonPHI();
+  if (pred_begin(BB) == pred_end(BB)) {
+    // The function entry, or a block nothing branches to: the register holds
+    // whatever the caller left in it.
+    LoadInst *LI = new LoadInst(Reg, Reg->getName(), BB->getFirstInsertionPt());
+    LI->setDebugLoc(First->getDebugLoc());
+    Loads.push_back(LI);
+    Def = LI;
+    return Def;
+  }
+
+  PHINode *Phi = PHINode::Create(Reg->getType()->getElementType(),
+    std::distance(pred_begin(BB), pred_end(BB)), Reg->getName(), &BB->front());
+  Phi->setDebugLoc(First->getDebugLoc());
+  Phis.push_back(Phi);
+  Incomplete.push_back(std::make_pair(Reg, Phi));
+  Def = Phi;
+  return Def;
+}
+
+Value* RegisterSSA::getEndDef(GlobalVariable *Reg, BasicBlock *BB) {
+  DenseMap<RegBlock, Value*>::iterator It =
+    EndDefs.find(std::make_pair(Reg, BB));
+  if (It != EndDefs.end())
+    return It->second;
+  // Nothing in BB writes the register, or BB is unreachable.
+  return getEntryDef(Reg, BB);
+}
+
+void RegisterSSA::rewriteBlock(BasicBlock *BB,
+  const std::vector<GlobalVariable*> &Regs) {
+  SmallPtrSet<GlobalVariable*, 32> RegSet;
+  RegSet.insert(Regs.begin(), Regs.end());
+  DenseMap<GlobalVariable*, Value*> Cur;
+
+  std::vector<Instruction*> Insts;
+  for (BasicBlock::iterator I = BB->begin(), E = BB->end(); I != E; ++I)
+    Insts.push_back(I);
+
+  for (unsigned i = 0, e = Insts.size(); i != e; ++i) {
+    Instruction *I = Insts[i];
+    if (LoadInst *LI = dyn_cast<LoadInst>(I)) {
+      GlobalVariable *Reg = dyn_cast<GlobalVariable>(LI->getPointerOperand());
+      if (Reg == NULL || !RegSet.count(Reg))
+        continue;
+      Value *&Def = Cur[Reg];
+      if (Def == NULL)
+        Def = getEntryDef(Reg, BB);
+      LI->replaceAllUsesWith(Def);
+      LI->eraseFromParent();
+      ++NumLoadsRemoved;
+      continue;
+    }
+    if (StoreInst *SI = dyn_cast<StoreInst>(I)) {
+      GlobalVariable *Reg = dyn_cast<GlobalVariable>(SI->getPointerOperand());
+      if (Reg == NULL || !RegSet.count(Reg))
+        continue;
+      Cur[Reg] = SI->getValueOperand();
+      SI->eraseFromParent();
+      ++NumStoresRemoved;
+      continue;
+    }
+
+    // Callees and callers see the registers in memory.
+    bool IsCall = isa<CallInst>(I) && !isa<IntrinsicInst>(I);
+    if (!IsCall && !isa<ReturnInst>(I))
+      continue;
+    for (unsigned r = 0, re = Regs.size(); r != re; ++r) {
+      Value *&Def = Cur[Regs[r]];
+      if (Def == NULL)
+        Def = getEntryDef(Regs[r], BB);
+      StoreInst *WB = new StoreInst(Def, Regs[r], I);
+      WB->setDebugLoc(I->getDebugLoc());
+      WriteBacks.push_back(WB);
+    }
+    if (!IsCall)
+      continue;
+    for (unsigned r = 0, re = Regs.size(); r != re; ++r) {
+      LoadInst *LI = new LoadInst(Regs[r], Regs[r]->getName());
+      LI->insertAfter(I);
+      LI->setDebugLoc(I->getDebugLoc());
+      Loads.push_back(LI);
+      Cur[Regs[r]] = LI;
+    }
+  }
+
+  for (DenseMap<GlobalVariable*, Value*>::iterator I = Cur.begin(),
+         E = Cur.end(); I != E; ++I)
+    EndDefs[std::make_pair(I->first, BB)] = I->second;
+}
+
+Value* RegisterSSA::tryRemoveTrivialPhi(PHINode *Phi) {
+  Value *Same = NULL;
+  for (unsigned i = 0, e = Phi->getNumIncomingValues(); i != e; ++i) {
+    Value *V = Phi->getIncomingValue(i);
+    if (V == Same || V == Phi)
+      continue;
+    if (Same != NULL)
+      return Phi;
+    Same = V;
+  }
+  // Only reachable through itself.
+  if (Same == NULL)
+    Same = UndefValue::get(Phi->getType());
+
+  // Phis that used this one may have become trivial.
+  std::vector<WeakVH> Users;
+  for (User *U : Phi->users())
+    if (U != Phi && isa<PHINode>(U))
+      Users.push_back(U);
+  Phi->replaceAllUsesWith(Same);
+  Phi->eraseFromParent();
+  for (unsigned i = 0, e = Users.size(); i != e; ++i)
+    if (PHINode *UP = dyn_cast_or_null<PHINode>(Users[i]))
+      tryRemoveTrivialPhi(UP);
+  return Same;
+}
+
+} // end namespace fracture
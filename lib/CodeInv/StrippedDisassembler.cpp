@@ -17,6 +17,7 @@
 
 #include "CodeInv/StrippedDisassembler.h"
 #include "CodeInv/StrippedGraph.h"
+#include "llvm/Support/Format.h"
 
 using namespace llvm;
 
@@ -46,94 +47,116 @@ uint64_t StrippedDisassembler::getStrippedSection(std::string section) {
   return Address;
 }
 
-//Returns address in hex
-uint64_t StrippedDisassembler::getHexAddress(MachineBasicBlock::iterator II) {
-
-  std::string mn;
-  uint64_t address;
-  std::stringstream sin;
-  unsigned Address = DAS->getDebugOffset(II->getDebugLoc());
-  unsigned Size = II->getDesc().getSize();
-  uint8_t *Bytes = new uint8_t(Size);
-  DAS->getCurSectionMemory()->readBytes(Bytes, Address, Size);
-  for (unsigned i = (Size/2); i >= 1; --i) {
-    sin << std::uppercase << std::hex << static_cast<int>(Bytes[i-1]);
-    mn.append(sin.str());
-    sin.str("");
-  }
-  std::stringstream ss;
-  ss << std::hex << mn;
-  ss >> address;
-
-  delete Bytes;
-  return address;
-
-}
 //Iterate through basic blocks of a section and push them to the graph
+//  NOTE: This loops from one function to the next rather than recursing, deep
+//  binaries would otherwise run out of stack.
 void StrippedDisassembler::functionsIterator(uint64_t Address) {
+  for (;;) {
+    MachineFunction *MF = DAS->disassemble(Address);
+    object::SectionRef Section = DAS->getSectionByAddress(Address);
+    DAS->setSection(Section);
+    MachineFunction::iterator BI = MF->begin(), BE = MF->end();
+
+    while (BI != BE
+      && DAS->getDebugOffset(BI->instr_begin()->getDebugLoc()) < Address) {
+      ++BI;
+    }
+    if (BI == BE) {
+      //outs() << "End of file\n";
+      return;
+    }
+    MachineBasicBlock::iterator II = BI->instr_begin(), IE = BI->instr_end();
 
-  MachineFunction *MF = DAS->disassemble(Address);
-  object::SectionRef Section = DAS->getSectionByAddress(Address);
-  DAS->setSection(Section);
-  MachineFunction::iterator BI = MF->begin(), BE = MF->end();
-  const char *Fmt;
-  Fmt = "%08" PRIx64;
-
-  while (BI != BE
-    && DAS->getDebugOffset(BI->instr_begin()->getDebugLoc()) < Address) {
-    ++BI;
-  }
-  if (BI == BE) {
-    //outs() << "End of file\n";
-    return;
-  }
-  MachineBasicBlock::iterator II = BI->instr_begin(), IE = BI->instr_end();
+    //Skip to first instruction
+    while (DAS->getDebugOffset(II->getDebugLoc()) < Address) {
+      if (II == IE) {
+        outs() << "Unreachable: reached end of basic block when looking for "
+          "first instruction.";
+        ++BI;
+        II = BI->instr_begin();
+        IE = BI->instr_end();
+      }
+      ++II;
+    }
+    if (Address != DAS->getDebugOffset(II->getDebugLoc())) {
+      outs() << "Warning: starting at "
+             << DAS->getDebugOffset(II->getDebugLoc())
+             << " instead of " << Address << ".\n";
+    }
 
-//Skip to first instruction
-  while (DAS->getDebugOffset(II->getDebugLoc()) < Address) {
-    if (II == IE) {
-      outs() << "Unreachable: reached end of basic block when looking for first"
-        " instruction.";
-      ++BI;
-      II = BI->instr_begin();
-      IE = BI->instr_end();
+    for (; BI != BE; ++BI) {
+      //Inside a new basic block
+      GraphNode *tempNode = new GraphNode;
+      tempNode->NodeBlock = BI;
+      tempNode->Address = DAS->getDebugOffset(BI->instr_begin()->getDebugLoc());
+      tempNode->End = DAS->getDebugOffset(BI->instr_rbegin()->getDebugLoc());
+
+      if (BI->instr_rbegin()->isBranch())
+        DAS->getInstTarget(&*BI->instr_rbegin(), tempNode->BranchAddress);
+      Graph->addGraphNode(tempNode);
+      Graph->addToList(tempNode);
+      if(DAS->getDebugOffset(BI->instr_rbegin()->getDebugLoc())
+        + BI->instr_rbegin()->getDesc().getSize() >= Section.getAddress()
+        + Section.getSize() - BI->instr_rbegin()->getDesc().getSize())
+        return;
     }
-    ++II;
-  }
-  if (Address != DAS->getDebugOffset(II->getDebugLoc())) {
-    outs() << "Warning: starting at " << DAS->getDebugOffset(II->getDebugLoc())
-        << " instead of " << Address << ".\n";
+    --BI;
+    Address = DAS->getDebugOffset(BI->instr_rbegin()->getDebugLoc())
+      + BI->instr_rbegin()->getDesc().getSize();
   }
+}
 
-  for (; BI != BE; ++BI) {
-//Inside a new basic block
-    uint64_t ad = DAS->getDebugOffset(BI->instr_begin()->getDebugLoc());
-    GraphNode *tempNode = new GraphNode;
-    tempNode->NodeBlock = BI;
-    tempNode->Address = DAS->getDebugOffset(BI->instr_begin()->getDebugLoc());
-    tempNode->End = DAS->getDebugOffset(BI->instr_rbegin()->getDebugLoc());
+// Finds the extent of every function in the section holding Address, seeded
+//   from Address, main (if it was found) and any function symbols, with
+//   raw byte prologue matches as candidates.
+void StrippedDisassembler::findStrippedFunctions(uint64_t Address) {
+  object::SectionRef Section = DAS->getSectionByAddress(Address);
+  DAS->setSection(Section);
 
-    if (BI->instr_rbegin()->isBranch()) {
-      uint64_t InstAddr = DAS->getDebugOffset(BI->instr_rbegin()->getDebugLoc());
-      uint64_t InstSize = (TripleName.find("arm") != std::string::npos) ? 8
-                          : BI->instr_rbegin()->getDesc().getSize();
-      uint64_t JumpAddr = 0;
+  FunctionDiscovery Discovery(DAS);
+  Discovery.addSeed(Address);
+  if (mainAddr != 0)
+    Discovery.addSeed(mainAddr);
+  Discovery.addSymbolSeeds(DAS->getExecutable());
+
+  // Prologues found in the raw bytes are cheap to find and let the descent
+  // reach most functions before the linear sweep has to decode the gaps.
+  PrologueScanner Scanner(TripleName);
+  std::vector<uint64_t> Starts;
+  Scanner.scan(*DAS->getCurSectionMemory(), Starts);
+  for (unsigned i = 0, e = Starts.size(); i != e; ++i)
+    Discovery.addCandidate(Starts[i]);
+  Discovery.run();
+  FunctionExtents = Discovery.getFunctions();
+  CFG = CompactCFG();
+  Discovery.buildCFG(CFG);
+  CFG.finalize();
+  NumPrologues = Starts.size();
+  NumPrologueFunctions = Discovery.getNumCandidateFunctions();
+}
 
-      if (BI->instr_rbegin()->getOperand(0).isImm())
-        JumpAddr = BI->instr_rbegin()->getOperand(0).getImm();
-      tempNode->BranchAddress = JumpAddr + InstSize + InstAddr;
+// Prints the blocks of every function found by findStrippedFunctions in
+//   depth first order, in the format of StrippedGraph::printGraph.
+void StrippedDisassembler::printCFG() {
+  const char *Fmt = "%08" PRIx64;
+  std::vector<CompactCFG::NodeID> Order;
+  for (auto &it : FunctionExtents) {
+    CompactCFG::NodeID Entry = CFG.findBlock(it.first);
+    if (Entry == CompactCFG::InvalidNode)
+      continue;
+    outs() << "Function Begin!\n";
+    CFG.depthFirst(Entry, Order);
+    for (auto &N : Order) {
+      // Tail jumps lead into other functions, which are printed on their own.
+      if (CFG.getStart(N) < it.first || CFG.getStart(N) >= it.second)
+        continue;
+      outs() << "Address: " << format(Fmt, CFG.getStart(N)) << "\n"
+             << "Successors: ";
+      for (auto &Succ : CFG.successors(N))
+        outs() << format(Fmt, CFG.getStart(Succ)) << " ";
+      outs() << "\n\n";
     }
-    Graph->addGraphNode(tempNode);
-    Graph->addToList(tempNode);
-    ad = DAS->getDebugOffset(BI->instr_rbegin()->getDebugLoc());
-    if(DAS->getDebugOffset(BI->instr_rbegin()->getDebugLoc())
-      + BI->instr_rbegin()->getDesc().getSize() >= Section.getAddress() 
-      + Section.getSize() - BI->instr_rbegin()->getDesc().getSize())
-      return;
   }
-  functionsIterator(DAS->getDebugOffset((--BI)->instr_rbegin()->getDebugLoc())
-                    + BI->instr_rbegin()->getDesc().getSize());
-  return;
 }
 
 // Sets mainAddr to the address of main in a stripped file.
@@ -189,62 +212,41 @@ void StrippedDisassembler::findStrippedMain() {
     outs() << "Warning: starting at " << DAS->getDebugOffset(II->getDebugLoc())
            << " instead of " << symbAddr << ".\n";
   }
-  if(TripleName.find("arm") != std::string::npos){
-    while (BI != BE) {
-      if(II->getOpcode() == 192 || II->getOpcode() == 152){
-        ++II;
-        ++II;
-        if(II->getOpcode() == 449 || II->getOpcode() == 415) {
-          while (BI != BE) {
-            if(II->getOpcode() == 197 && pre == 197){
-              for(int x = 0; x < 4; x++)
-                ++II;
-              Address = getHexAddress(II);
-              outs() << "ARM main address is: " << Address << "\n";
-              mainAddr = Address;
-              return;
-            }
-
-            pre = II->getOpcode();
-            ++II;
-
-          }
-        }
-      }
-
-      ++II;
-      if (II == IE) {
-        ++BI;
-        II = BI->instr_begin();
-        IE = BI->instr_end();
-      }
-    }
-  }
-
-  else if((TripleName.find("i386") != std::string::npos) || (TripleName.find("x86") != std::string::npos)) {
-    while(BI != BE) {
-      if(II->getOpcode() >= 8472 && II->getOpcode() <= 8511)
+  // Walk the crt start code until its signature completes. On targets that
+  // pass main as an immediate the completing instruction is the call into
+  // libc, otherwise it is the load of the next argument and main's address
+  // is in the literal read by the load before it.
+  const StrippedSignatures *Sigs = Graph->getSignatures();
+  StrippedSignatures::Scanner Scan(*Sigs);
+  MachineInstr *PrevMI = NULL;
+  while (BI != BE) {
+    if (II == IE) {
+      if (++BI == BE)
         break;
-      ++II;
-      if (II == IE) {
-        ++BI;
-        II = BI->instr_begin();
-        IE = BI->instr_end();
-      }
+      II = BI->instr_begin();
+      IE = BI->instr_end();
+      continue;
     }
-    while(BI != BE) {
-      if(II->getOpcode() >= 353 && II->getOpcode() <= 361) {
-          outs() << "Intel main address is: " << pre << "\n";
-          mainAddr = pre;
-          return;
-        }
-//32b systems have the address in op0 64b in op1
-      if(II->getOperand(0).isImm())
-        pre = II->getOperand(0).getImm();
-      else if(II->getOperand(1).isImm())
-        pre = II->getOperand(1).getImm();
-      ++II;
+    if (Scan.step(II->getOpcode()) == StrippedSignatures::StartToMain) {
+      if (Sigs->isA(StrippedSignatures::Call, II->getOpcode())) {
+        outs() << "Main address is: " << pre << "\n";
+        mainAddr = pre;
+        return;
+      }
+      if (PrevMI != NULL && DAS->getLoadedWord(PrevMI, Address)) {
+        outs() << "Main address is: " << Address << "\n";
+        mainAddr = Address;
+        return;
+      }
+      break;
     }
+    //32b systems have the address in op0 64b in op1
+    if (II->getNumOperands() > 0 && II->getOperand(0).isImm())
+      pre = II->getOperand(0).getImm();
+    else if (II->getNumOperands() > 1 && II->getOperand(1).isImm())
+      pre = II->getOperand(1).getImm();
+    PrevMI = &*II;
+    ++II;
   }
   outs() << "No success finding main RETURNING\n";
    return;
@@ -32,7 +32,7 @@ void StrippedGraph::addGraphNode(GraphNode *Node) {
   // If the graph is empty, start a new node with the first basic block.
   if (HeadNodes.empty()) {
     PrevNode = Node;
-    HeadNodes.push_back(Node);
+    addHeadNode(Node);
     return;
   }
   // If the previous basic block ends with a return instruction that is
@@ -42,24 +42,21 @@ void StrippedGraph::addGraphNode(GraphNode *Node) {
       && !isConditionalTerminator(PrevNode))
       || isFunctionBegin(Node)) {
     //outs() << "Prev is Terminator\n";
-    HeadNodes.push_back(Node);
+    addHeadNode(Node);
   }
   // If the previous basic block ends with a conditional branch, we want to
   // automatically add the current node as a successor to the previous node,
   // and push the previous node into the NeedsLink vector for later linking
-  // of the other successor. 
+  // of the other successor.
   if (PrevNode->NodeBlock->instr_rbegin()->isConditionalBranch() &&
            !isAddressInBasicBlock(PrevNode->BranchAddress, Node)) {
     PrevNode->SuccNodes.push_back(Node);
-    NeedsLink.push_back(PrevNode);
+    resolveLinks(PrevNode);
   }
   // If the current block ends with an unconditional branch, we want to
-  // push it into NeedsLink for later linking.
+  // link it to its target now or once the target block is added.
   if (Node->NodeBlock->instr_rbegin()->isUnconditionalBranch())
-    NeedsLink.push_back(Node);
-  // If there are links that need to be resolved, attempt to resolve them.
-  if (!NeedsLink.empty())
-    resolveLinks();
+    resolveLinks(Node);
 
   PrevNode = Node;
   /*outs() << "NeedsLink: ";
@@ -72,24 +69,46 @@ void StrippedGraph::addGraphNode(GraphNode *Node) {
 
 void StrippedGraph::addToList(GraphNode *Node) {
   AllNodes.push_back(Node);
+  NodeIndex[Node->Address] = Node;
+
+  // Link every pending branch that lands inside the new block.
+  std::multimap<uint64_t, GraphNode *>::iterator
+    It = NeedsLink.lower_bound(Node->Address),
+    End = NeedsLink.upper_bound(Node->End);
+  while (It != End) {
+    if (!isAlreadySuccessor(It->second, Node))
+      It->second->SuccNodes.push_back(Node);
+    NeedsLink.erase(It++);
+  }
 }
 
-void StrippedGraph::resolveLinks() {
-  bool NodeDeleted = false;
-  for (std::vector<GraphNode *>::iterator vecit = NeedsLink.begin();
-       vecit != NeedsLink.end(); ) {
-    for(auto &it : AllNodes) {
-      if (isAddressInBasicBlock((*vecit)->BranchAddress, it) &&
-          !isAlreadySuccessor(*vecit, it)) {
-        (*vecit)->SuccNodes.push_back(it);
-        vecit = NeedsLink.erase(vecit);
-        NodeDeleted = true;
-      }
-    }
-    if(!NodeDeleted)
-      vecit++;
-    NodeDeleted = false; 
+void StrippedGraph::addHeadNode(GraphNode *Node) {
+  HeadNodes.push_back(Node);
+  HeadIndex[Node->Address] = Node;
+}
+
+void StrippedGraph::resolveLinks(GraphNode *Node) {
+  GraphNode *Target = findNode(NodeIndex, Node->BranchAddress);
+  if (Target == NULL) {
+    // Forward branch, linked by addToList once the target shows up.
+    NeedsLink.insert(std::make_pair(Node->BranchAddress, Node));
+    return;
   }
+  if (!isAlreadySuccessor(Node, Target))
+    Node->SuccNodes.push_back(Target);
+}
+
+GraphNode *StrippedGraph::findNode(const std::map<uint64_t, GraphNode *> &Index,
+                                   uint64_t Address) {
+  // The last block starting at or before Address is the only candidate.
+  std::map<uint64_t, GraphNode *>::const_iterator It =
+    Index.upper_bound(Address);
+  if (It == Index.begin())
+    return NULL;
+  --It;
+  if (!isAddressInBasicBlock(Address, It->second))
+    return NULL;
+  return It->second;
 }
 
 void StrippedGraph::printGraph() {
@@ -117,16 +136,23 @@ void StrippedGraph::printNode(GraphNode *Node) {
 }
 
 void StrippedGraph::printVisit(GraphNode *Node) {
-  if (Node->NodeColor == Color::GRAY) {
-    printNode(Node);
-    for (auto &it : Node->SuccNodes) {
-      if(it->Address == it->BranchAddress)
+  // Explicit stack, successors pushed in reverse to keep the visit order.
+  std::vector<GraphNode *> Stack;
+  Stack.push_back(Node);
+  while (!Stack.empty()) {
+    GraphNode *Cur = Stack.back();
+    Stack.pop_back();
+    if (Cur->NodeColor != Color::GRAY)
+      continue;
+    printNode(Cur);
+    for (std::vector<GraphNode *>::reverse_iterator it = Cur->SuccNodes.rbegin();
+         it != Cur->SuccNodes.rend(); ++it) {
+      if((*it)->Address == (*it)->BranchAddress)
         continue;
-      if(isSuccessorLoop(it))
+      if(isSuccessorLoop(*it))
         continue;
-      printVisit(it);
+      Stack.push_back(*it);
     }
-    //Node->NodeColor = Color::BLACK;
   }
 }
 
@@ -137,10 +163,7 @@ bool StrippedGraph::isAddressInBasicBlock(uint64_t Address, GraphNode *Node) {
 }
 
 bool StrippedGraph::isJumpToCompleteFunction(GraphNode *Node) {
-  for (auto &it : HeadNodes)
-    if (isAddressInBasicBlock(Node->BranchAddress, it))
-      return true;
-  return false;
+  return findNode(HeadIndex, Node->BranchAddress) != NULL;
 }
 
 void StrippedGraph::initializeColors() {
@@ -165,43 +188,36 @@ bool StrippedGraph::isSuccessorLoop(GraphNode *Node) {
 
 MachineInstr *StrippedGraph::bypassNops(GraphNode *Node) {
   for (MachineBasicBlock::iterator MI = Node->NodeBlock->instr_begin();
-       MI != Node->NodeBlock->instr_end(); MI++) {
-    unsigned opcode = MI->getOpcode();
-    if (Triple.find("i386") != std::string::npos ||
-        Triple.find("x86_64") != std::string::npos) {
-
-      if (opcode >= 1817 && opcode <= 1819) // NOOP
-        continue;
-      if (opcode >= 8451 && opcode <= 8463) // XCH
-        continue;
-      if (opcode >= 1213 && opcode <= 1216) // LEA
-        continue;
-    }
-    if (Triple.find("arm") != std::string::npos) {
-      if (opcode >= 42 && opcode <= 45 &&  // ANDEQ
-          MI->getOperand(MI->findFirstPredOperandIdx()).getImm() == 0)
-        continue;
-      if (opcode >= 244 && opcode <= 245 &&  // MULEQ
-          MI->getOperand(MI->findFirstPredOperandIdx()).getImm() == 0)
-        continue;
-      if (opcode >= 155 && opcode <= 198 &&  // LDREQ
-
-          MI->getOperand(MI->findFirstPredOperandIdx()).getImm() == 0)
-        continue;
-    }
-    return &(*MI);
-  }
+       MI != Node->NodeBlock->instr_end(); MI++)
+    if (!Sigs->isA(StrippedSignatures::NopPadding, &*MI))
+      return &(*MI);
   return NULL;
 }
 
 void StrippedGraph::correctHeadNodes() {
   for (auto &it : HeadNodes) {
     MachineInstr *temp = bypassNops(it);
-    if (temp != NULL)
-      it->Address = DAS->getDebugOffset(temp->getDebugLoc());
+    if (temp == NULL)
+      continue;
+    uint64_t Address = DAS->getDebugOffset(temp->getDebugLoc());
+    if (Address == it->Address)
+      continue;
+    // Keep the indexes keyed by the start of each block.
+    rekeyNode(NodeIndex, it, Address);
+    rekeyNode(HeadIndex, it, Address);
+    it->Address = Address;
   }
 }
 
+void StrippedGraph::rekeyNode(std::map<uint64_t, GraphNode *> &Index,
+                              GraphNode *Node, uint64_t Address) {
+  std::map<uint64_t, GraphNode *>::iterator It = Index.find(Node->Address);
+  if (It == Index.end() || It->second != Node)
+    return;
+  Index.erase(It);
+  Index[Address] = Node;
+}
+
 bool StrippedGraph::isConditionalTerminator(GraphNode *Node) {
   if (Node->NodeBlock->instr_rbegin()->isPredicable()) {
     int predOpIndex = Node->NodeBlock->instr_rbegin()->findFirstPredOperandIdx();
@@ -218,20 +234,11 @@ bool StrippedGraph::isConditionalTerminator(GraphNode *Node) {
 
 bool StrippedGraph::isFunctionBegin(GraphNode *Node) {
   MachineInstr *begin = bypassNops(Node);
-  if (Triple.find("arm") != std::string::npos)
-    if (begin->getOpcode() >= 412 && begin->getOpcode() <= 417)
-      for (MachineInstr::mop_iterator mop = begin->operands_begin();
-           mop != begin->operands_end(); ++mop)
-        if (mop->isReg() && mop->getReg() == 10)
-          return true;
-  if (Triple.find("i386") != std::string::npos ||
-      Triple.find("x86_64") != std::string::npos)
-    if (begin->getOpcode() >= 2227 && begin->getOpcode() <= 2261)
-      for (MachineInstr::mop_iterator mop = begin->operands_begin();
-           mop != begin->operands_end(); ++mop)
-        if (mop->isReg() && (mop->getReg() == 20 || mop->getReg() == 36)
-            && !PrevNode->NodeBlock->instr_rbegin()->isConditionalBranch())
-          return true;
-  return false;
+  if (begin == NULL || !Sigs->isA(StrippedSignatures::FunctionEntry, begin))
+    return false;
+  // A frame setup right after a conditional branch is more likely a shrink
+  // wrapped path inside the same function.
+  return PrevNode == NULL ||
+    !PrevNode->NodeBlock->instr_rbegin()->isConditionalBranch();
 }
 } // end namespace fracture
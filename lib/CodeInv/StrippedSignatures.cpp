@@ -0,0 +1,271 @@
+//===--- StrippedSignatures - Opcode signatures for stripped code -*- C++ -*-===//
+//
+//              Fracture: The Draper Decompiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Per-target tables of instruction classes and signatures used to find
+// functions and main in stripped binaries.
+//
+//===----------------------------------------------------------------------===//
+
+#include "CodeInv/StrippedSignatures.h"
+#include "llvm/ADT/Triple.h"
+#include "llvm/MC/MCInstrInfo.h"
+#include "llvm/MC/MCRegisterInfo.h"
+
+#include <algorithm>
+
+using namespace llvm;
+
+namespace fracture {
+
+namespace {
+
+typedef StrippedSignatures SS;
+
+struct ClassDesc {
+  const char *Arch;      // Triple::getArchTypePrefix of the target.
+  SS::InstClass Class;
+  const char *Names;     // Comma separated, a trailing '*' matches a prefix.
+  const char *Regs;      // If set, one of these must be a register operand.
+  int PredImm;           // If not -1, the required predicate immediate.
+  bool SelfMove;         // Only counts if it leaves its register unchanged.
+};
+
+const ClassDesc ClassTable[] = {
+  // int3 fills the gaps between functions on some toolchains.
+  { "x86", SS::NopPadding, "NOOP*,INT3", nullptr, -1, false },
+  // xchg esi, esi / lea esi, [esi + 0] are multi-byte fillers, but any other
+  // lea or xchg is real code (e.g., lea ecx, [esp + 4] opening main). The
+  // accumulator forms of xchg are left out, their EAX operand is implicit.
+  { "x86", SS::NopPadding, "XCHG16rr,XCHG32rr,XCHG64rr,LEA*", nullptr, -1,
+    true },
+  // push ebp / push rbp
+  { "x86", SS::FunctionEntry, "PUSH*", "EBP,RBP", -1, false },
+  // _start: xor ebp, ebp ... push $main; call __libc_start_main
+  { "x86", SS::StartEntry, "XOR*", nullptr, -1, false },
+  { "x86", SS::Call, "CALL*", nullptr, -1, false },
+
+  // andeq r0, r0, r0 and similar words decode as EQ-predicated no-ops.
+  { "arm", SS::NopPadding, "AND*,MUL*,LDR*", nullptr, 0, false },
+  // push {..., lr}
+  { "arm", SS::FunctionEntry, "STM*", "LR", -1, false },
+  // _start: pop {r1}; mov r2, sp; push {r2}; ... ldr r0, =main
+  { "arm", SS::StartEntry, "LDR_POST_IMM,LDMIA_UPD", nullptr, -1, false },
+  { "arm", SS::StartPush, "STR_PRE_IMM,STMDB_UPD", nullptr, -1, false },
+  { "arm", SS::LiteralLoad, "LDRi12", nullptr, -1, false },
+  { "arm", SS::Call, "BL,BLX*,tBL*", nullptr, -1, false }
+};
+
+struct SignatureDesc {
+  const char *Arch;
+  SS::Signature Sig;
+  SS::InstClass Steps[8];
+  unsigned NumSteps;
+};
+
+const SignatureDesc SignatureTable[] = {
+  { "x86", SS::StartToMain, { SS::StartEntry, SS::AnyGap, SS::Call }, 3 },
+  { "arm", SS::StartToMain, { SS::StartEntry, SS::AnyInst, SS::StartPush,
+      SS::AnyGap, SS::LiteralLoad, SS::LiteralLoad }, 6 }
+};
+
+bool matchesName(StringRef Name, StringRef Pattern) {
+  if (Pattern.endswith("*"))
+    return Name.startswith(Pattern.drop_back());
+  return Name == Pattern;
+}
+
+// Tracks the operands of a self move: a single register throughout, and
+// immediates that are all zero but for one 1 (the scale of an address).
+class SelfMoveCheck {
+public:
+  SelfMoveCheck() : Reg(0), SeenOne(false), OK(true) {}
+  void addReg(unsigned R) {
+    if (R == 0)
+      return;
+    OK &= Reg == 0 || Reg == R;
+    Reg = R;
+  }
+  void addImm(int64_t Imm) {
+    if (Imm == 1 && !SeenOne)
+      SeenOne = true;
+    else
+      OK &= Imm == 0;
+  }
+  void addOther() { OK = false; }
+  bool isSelfMove() const { return OK && Reg != 0; }
+private:
+  unsigned Reg;
+  bool SeenOne, OK;
+};
+
+} // end anonymous namespace
+
+StrippedSignatures::StrippedSignatures(const MCDirector *MC,
+  StringRef TripleName) : MII(MC->getMCInstrInfo()), Supported(false),
+  StartBits(0), GapBits(0) {
+  for (unsigned i = 0; i != NumSignatures; ++i)
+    EndBits[i] = 0;
+
+  const MCRegisterInfo *MRI = MC->getMCRegisterInfo();
+  for (unsigned i = 0; i != NumInstClasses; ++i) {
+    Classes[i].Opcodes.resize(MII->getNumOpcodes());
+    Classes[i].SelfMoves.resize(MII->getNumOpcodes());
+  }
+  StepMasks.assign(MII->getNumOpcodes(), 0);
+
+  StringRef Arch = Triple::getArchTypePrefix(Triple(TripleName).getArch());
+  if (Arch.empty())
+    return;
+
+  for (const ClassDesc &D : ClassTable) {
+    if (Arch != D.Arch)
+      continue;
+    addClass(D.Class, D.Names, D.Regs ? D.Regs : "", D.PredImm, D.SelfMove,
+      MII, MRI);
+    Supported = true;
+  }
+
+  unsigned NextBit = 0;
+  for (const SignatureDesc &D : SignatureTable)
+    if (Arch == D.Arch)
+      addSignature(D.Sig, makeArrayRef(D.Steps, D.NumSteps), NextBit);
+}
+
+void StrippedSignatures::addClass(InstClass Class, StringRef Names,
+  StringRef Regs, int PredImm, bool SelfMove, const MCInstrInfo *MII,
+  const MCRegisterInfo *MRI) {
+  ClassInfo &CI = Classes[Class];
+  CI.PredImm = PredImm;
+
+  SmallVector<StringRef, 8> Patterns;
+  Names.split(Patterns, ",");
+  for (unsigned Op = 0, E = MII->getNumOpcodes(); Op != E; ++Op) {
+    StringRef Name = MII->getName(Op);
+    for (StringRef P : Patterns)
+      if (matchesName(Name, P)) {
+        CI.Opcodes.set(Op);
+        if (SelfMove)
+          CI.SelfMoves.set(Op);
+        break;
+      }
+  }
+
+  if (Regs.empty())
+    return;
+  SmallVector<StringRef, 4> RegNames;
+  Regs.split(RegNames, ",");
+  for (unsigned Reg = 1, E = MRI->getNumRegs(); Reg != E; ++Reg)
+    for (StringRef R : RegNames)
+      if (R == MRI->getName(Reg))
+        CI.Regs.push_back(Reg);
+}
+
+void StrippedSignatures::addSignature(Signature Sig, ArrayRef<InstClass> Steps,
+  unsigned &NextBit) {
+  assert(NextBit + Steps.size() <= 64 && "Too many signature steps");
+  StartBits |= 1ULL << NextBit;
+  for (InstClass Step : Steps) {
+    uint64_t Bit = 1ULL << NextBit++;
+    if (Step == AnyInst || Step == AnyGap) {
+      for (uint64_t &Mask : StepMasks)
+        Mask |= Bit;
+      if (Step == AnyGap)
+        GapBits |= Bit;
+      continue;
+    }
+    const BitVector &Opcodes = Classes[Step].Opcodes;
+    for (int Op = Opcodes.find_first(); Op != -1; Op = Opcodes.find_next(Op))
+      StepMasks[Op] |= Bit;
+  }
+  EndBits[Sig] |= 1ULL << (NextBit - 1);
+}
+
+bool StrippedSignatures::isA(InstClass Class, const MachineInstr *MI) const {
+  if (!isA(Class, MI->getOpcode()))
+    return false;
+
+  const ClassInfo &CI = Classes[Class];
+  if (CI.PredImm != -1) {
+    int PredIdx = MI->findFirstPredOperandIdx();
+    if (PredIdx == -1 || MI->getOperand(PredIdx).getImm() != CI.PredImm)
+      return false;
+  }
+  if (CI.SelfMoves.test(MI->getOpcode())) {
+    SelfMoveCheck Check;
+    for (MachineInstr::const_mop_iterator MO = MI->operands_begin(),
+           ME = MI->operands_end(); MO != ME; ++MO) {
+      if (MO->isReg()) {
+        if (!MO->isImplicit())
+          Check.addReg(MO->getReg());
+      } else if (MO->isImm())
+        Check.addImm(MO->getImm());
+      else
+        Check.addOther();
+    }
+    if (!Check.isSelfMove())
+      return false;
+  }
+  if (CI.Regs.empty())
+    return true;
+  for (MachineInstr::const_mop_iterator MO = MI->operands_begin(),
+         ME = MI->operands_end(); MO != ME; ++MO)
+    if (MO->isReg() && std::find(CI.Regs.begin(), CI.Regs.end(),
+                                 MO->getReg()) != CI.Regs.end())
+      return true;
+  return false;
+}
+
+bool StrippedSignatures::isA(InstClass Class, const MCInst &Inst) const {
+  if (!isA(Class, Inst.getOpcode()))
+    return false;
+
+  const ClassInfo &CI = Classes[Class];
+  if (CI.PredImm != -1) {
+    int PredIdx = MII->get(Inst.getOpcode()).findFirstPredOperandIdx();
+    if (PredIdx == -1 || unsigned(PredIdx) >= Inst.getNumOperands()
+        || !Inst.getOperand(PredIdx).isImm()
+        || Inst.getOperand(PredIdx).getImm() != CI.PredImm)
+      return false;
+  }
+  if (CI.SelfMoves.test(Inst.getOpcode())) {
+    SelfMoveCheck Check;
+    for (unsigned i = 0, e = Inst.getNumOperands(); i != e; ++i) {
+      const MCOperand &MO = Inst.getOperand(i);
+      if (MO.isReg())
+        Check.addReg(MO.getReg());
+      else if (MO.isImm())
+        Check.addImm(MO.getImm());
+      else
+        Check.addOther();
+    }
+    if (!Check.isSelfMove())
+      return false;
+  }
+  if (CI.Regs.empty())
+    return true;
+  for (unsigned i = 0, e = Inst.getNumOperands(); i != e; ++i) {
+    const MCOperand &MO = Inst.getOperand(i);
+    if (MO.isReg() && std::find(CI.Regs.begin(), CI.Regs.end(),
+                                MO.getReg()) != CI.Regs.end())
+      return true;
+  }
+  return false;
+}
+
+StrippedSignatures::Signature
+StrippedSignatures::Scanner::step(unsigned Opcode) {
+  uint64_t Mask = Opcode < Sigs.StepMasks.size() ? Sigs.StepMasks[Opcode] : 0;
+  State = (((State << 1) | Sigs.StartBits) & Mask) | (State & Sigs.GapBits);
+  for (unsigned i = 0; i != NumSignatures; ++i)
+    if (State & Sigs.EndBits[i])
+      return static_cast<Signature>(i);
+  return NoSignature;
+}
+
+} // end namespace fracture
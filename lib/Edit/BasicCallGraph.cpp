@@ -22,6 +22,14 @@ BasicCallGraph::BasicCallGraph(Module &M) : CallGraph(M),
   ExternalCallingNode = getOrInsertFunction(0);
   CallsExternalNode = new CallGraphNode(0);
   Root = 0;
+
+  // CallGraph has already added every function, but its edges to external
+  // code go to its own CallsExternalNode, which rescans would not use.
+  // Rebuild them here, so there is one such node and Callers counts them.
+  for (iterator I = begin(), E = end(); I != E; ++I)
+    I->second->removeAllCalledFunctions();
+  for (Module::iterator FI = M.begin(), FE = M.end(); FI != FE; ++FI)
+    addToCallGraph(FI);
 }
 
 void BasicCallGraph::viewFunctionInDotty(const Function *F) {
@@ -31,12 +39,14 @@ void BasicCallGraph::viewFunctionInDotty(const Function *F) {
 void BasicCallGraph::addToCallGraph(Function *F) {
   CallGraphNode *Node = getOrInsertFunction(F);
 
-  // If this function has external linkage, anything could call it.
-  if (!F->hasLocalLinkage()) {
-    ExternalCallingNode->addCalledFunction(CallSite(), Node);
+  // If this function has external linkage or its address taken, anything
+  // could call it. A function that is rescanned already has the edge.
+  if ((!F->hasLocalLinkage() || F->hasAddressTaken())
+      && !Callers[Node].count(ExternalCallingNode)) {
+    addEdge(ExternalCallingNode, CallSite(), Node);
 
     // Found the entry point?
-    if (F->getName() == "main") {
+    if (!F->hasLocalLinkage() && F->getName() == "main") {
       if (Root)    // Found multiple external mains?  Don't pick one.
         Root = ExternalCallingNode;
       else
@@ -44,31 +54,119 @@ void BasicCallGraph::addToCallGraph(Function *F) {
     }
   }
 
-  // If this function has its address taken, anything could call it.
-  if (F->hasAddressTaken())
-    ExternalCallingNode->addCalledFunction(CallSite(), Node);
-
   // If this function is not defined in this translation unit, it could call
   // anything.
   if (F->isDeclaration() && !F->isIntrinsic())
-    Node->addCalledFunction(CallSite(), CallsExternalNode);
+    addEdge(Node, CallSite(), CallsExternalNode);
 
   // Look for calls by this function.
   for (Function::iterator BB = F->begin(), BBE = F->end(); BB != BBE; ++BB)
     for (BasicBlock::iterator II = BB->begin(), IE = BB->end(); II != IE;
         ++II) {
       CallSite CS(cast<Value>(II));
-      if (CS) {
-        const Function *Callee = CS.getCalledFunction();
-        if (!Callee)
-          // Indirect calls of intrinsics are not allowed so no need to check.
-          Node->addCalledFunction(CS, CallsExternalNode);
-        else if (!Callee->isIntrinsic())
-          Node->addCalledFunction(CS, getOrInsertFunction(Callee));
-      }
+      if (!CS)
+        continue;
+      if (CallGraphNode *Callee = getCalleeNode(CS))
+        addEdge(Node, CS, Callee);
     }
 }
 
+CallGraphNode* BasicCallGraph::getCalleeNode(CallSite CS) {
+  const Function *Callee = CS.getCalledFunction();
+  if (!Callee)
+    // Indirect calls of intrinsics are not allowed so no need to check.
+    return CallsExternalNode;
+  if (Callee->isIntrinsic())
+    return 0;
+  return getOrInsertFunction(Callee);
+}
+
+void BasicCallGraph::addEdge(CallGraphNode *Caller, CallSite CS,
+    CallGraphNode *Callee) {
+  Caller->addCalledFunction(CS, Callee);
+  ++Callers[Callee][Caller];
+}
+
+void BasicCallGraph::forgetEdge(CallGraphNode *Caller,
+    CallGraphNode *Callee) {
+  DenseMap<CallGraphNode*, DenseMap<CallGraphNode*, unsigned> >::iterator
+    It = Callers.find(Callee);
+  if (It == Callers.end())
+    return;
+  DenseMap<CallGraphNode*, unsigned>::iterator Count = It->second.find(Caller);
+  if (Count != It->second.end() && --Count->second == 0)
+    It->second.erase(Count);
+}
+
+void BasicCallGraph::removeCallEdges(CallGraphNode *Node) {
+  for (CallGraphNode::iterator I = Node->begin(), E = Node->end(); I != E; ++I)
+    forgetEdge(Node, I->second);
+  Node->removeAllCalledFunctions();
+}
+
+CallGraphNode* BasicCallGraph::addFunction(Function *F) {
+  CallGraphNode *Node = getOrInsertFunction(F);
+  removeCallEdges(Node);
+  addToCallGraph(F);
+  return Node;
+}
+
+Function* BasicCallGraph::removeFunction(Function *F) {
+  CallGraphNode *Node = getOrInsertFunction(F);
+  removeCallEdges(Node);
+
+  DenseMap<CallGraphNode*, DenseMap<CallGraphNode*, unsigned> >::iterator
+    It = Callers.find(Node);
+  if (It != Callers.end()) {
+    for (DenseMap<CallGraphNode*, unsigned>::iterator I = It->second.begin(),
+        E = It->second.end(); I != E; ++I)
+      I->first->removeAnyCallEdgeTo(Node);
+    Callers.erase(It);
+  }
+
+  if (Root == Node)
+    Root = 0;
+  return removeFunctionFromModule(Node);
+}
+
+void BasicCallGraph::addCallEdge(CallSite CS) {
+  if (CallGraphNode *Callee = getCalleeNode(CS))
+    addEdge(getOrInsertFunction(CS.getCaller()), CS, Callee);
+}
+
+void BasicCallGraph::removeCallEdge(CallSite CS) {
+  CallGraphNode *Caller = getOrInsertFunction(CS.getCaller());
+  for (CallGraphNode::iterator I = Caller->begin(), E = Caller->end(); I != E;
+      ++I) {
+    if (I->first != CS.getInstruction())
+      continue;
+    forgetEdge(Caller, I->second);
+    Caller->removeCallEdgeFor(CS);
+    return;
+  }
+}
+
+void BasicCallGraph::updateCallEdge(CallSite CS) {
+  CallGraphNode *Caller = getOrInsertFunction(CS.getCaller());
+  CallGraphNode *Callee = getCalleeNode(CS);
+  for (CallGraphNode::iterator I = Caller->begin(), E = Caller->end(); I != E;
+      ++I) {
+    if (I->first != CS.getInstruction())
+      continue;
+    forgetEdge(Caller, I->second);
+    if (Callee) {
+      Caller->replaceCallEdge(CS, CS, Callee);
+      ++Callers[Callee][Caller];
+    } else
+      Caller->removeCallEdgeFor(CS);
+    return;
+  }
+
+  // There was no edge, e.g. the old callee was an intrinsic.
+  if (Callee)
+    addEdge(Caller, CS, Callee);
+}
+
 void BasicCallGraph::destroy() {
   /// CallsExternalNode is not in the function map, delete it explicitly.
   if (CallsExternalNode) {
@@ -15,9 +15,44 @@
 //===----------------------------------------------------------------------===//
 
 #include "Edit/StructuredModuleEditor.h"
+#include "llvm/ADT/SmallPtrSet.h"
+
+#include <algorithm>
+#include <functional>
+#include <thread>
 
 using namespace llvm;
 
+typedef std::vector<std::pair<Function*, Instruction*> > CallList;
+
+/// Functions each thread scans at least when the call site index is built.
+static const unsigned MinFuncsPerShard = 2048;
+
+/// Appends the direct, non-intrinsic calls made by Funcs[Begin, End) to
+/// Calls, in order. Shards are scanned in parallel, so nothing here may
+/// touch the context: isa<IntrinsicInst> and getIntrinsicID fill a cache in
+/// it, where Function::isIntrinsic only looks at the name.
+static void scanCalls(const std::vector<Function*> &Funcs, size_t Begin,
+		size_t End, CallList &Calls) {
+	for (size_t i = Begin; i != End; ++i) {
+		Function *F = Funcs[i];
+		for (Function::iterator BBI = F->begin(), BBE = F->end(); BBI != BBE;
+				++BBI) {
+			for (BasicBlock::iterator II = BBI->begin(), IE = BBI->end();
+					II != IE; ++II) {
+				CallSite CS(cast<Value>(II));
+				if (!CS)
+					continue;
+
+				// Direct calls only, and not to an intrinsic
+				Function *Callee = CS.getCalledFunction();
+				if (Callee != NULL && !Callee->isIntrinsic())
+					Calls.push_back(std::make_pair(Callee, CS.getInstruction()));
+			}
+		}
+	}
+}
+
 StructuredModuleEditor::StructuredModuleEditor(const std::string &Filename,
 		raw_ostream &OS) :
 		M(0), CG(0), OS(OS) {
@@ -26,12 +61,108 @@ StructuredModuleEditor::StructuredModuleEditor(const std::string &Filename,
 
 	// Generates a call graph for the module
 	CG = new BasicCallGraph(*M);
+	buildIndices();
 }
 
 StructuredModuleEditor::StructuredModuleEditor(Module *M, raw_ostream &OS) :
 		M(M), CG(0), OS(OS) {
 	// Generates a call graph for the module
 	CG = new BasicCallGraph(*M);
+	buildIndices();
+}
+
+void StructuredModuleEditor::buildIndices() {
+	CallSites.clear();
+	Signatures.clear();
+	UseChains.clear();
+
+	FuncList Funcs;
+	for (Module::iterator FI = M->begin(), FE = M->end(); FI != FE; ++FI)
+		Funcs.push_back(FI);
+
+	// Shards are contiguous and merged in order, so the index is the same for
+	// any number of threads.
+	size_t NumShards = std::min<size_t>(std::thread::hardware_concurrency(),
+			Funcs.size() / MinFuncsPerShard);
+	if (NumShards < 2)
+		NumShards = 1;
+	std::vector<CallList> Shards(NumShards);
+	size_t ShardSize = (Funcs.size() + NumShards - 1) / NumShards;
+	if (NumShards == 1) {
+		scanCalls(Funcs, 0, Funcs.size(), Shards[0]);
+	} else {
+		std::vector<std::thread> Workers;
+		for (size_t i = 0; i != NumShards; ++i) {
+			size_t Begin = std::min(i * ShardSize, Funcs.size());
+			size_t End = std::min(Begin + ShardSize, Funcs.size());
+			Workers.push_back(std::thread(scanCalls, std::cref(Funcs), Begin, End,
+					std::ref(Shards[i])));
+		}
+		for (size_t i = 0; i != NumShards; ++i)
+			Workers[i].join();
+	}
+
+	for (size_t i = 0; i != NumShards; ++i)
+		for (CallList::iterator I = Shards[i].begin(), E = Shards[i].end();
+				I != E; ++I)
+			CallSites[I->first].push_back(I->second);
+
+	// Signature keys may create types, which the context does not allow from
+	// several threads.
+	for (FuncList::iterator FI = Funcs.begin(), FE = Funcs.end(); FI != FE;
+			++FI)
+		Signatures[getSignatureKey(*FI)].push_back(*FI);
+}
+
+void StructuredModuleEditor::indexFunction(Function *F) {
+	FuncList Funcs(1, F);
+	CallList Calls;
+	scanCalls(Funcs, 0, 1, Calls);
+	for (CallList::iterator I = Calls.begin(), E = Calls.end(); I != E; ++I)
+		CallSites[I->first].push_back(I->second);
+	Signatures[getSignatureKey(F)].push_back(F);
+	UseChains.clear();
+}
+
+void StructuredModuleEditor::unindexFunction(Function *F) {
+	FuncList Funcs(1, F);
+	CallList Calls;
+	scanCalls(Funcs, 0, 1, Calls);
+	for (CallList::iterator I = Calls.begin(), E = Calls.end(); I != E; ++I)
+		if (I->first != F)
+			moveCall(I->second, I->first, NULL);
+	CallSites.erase(F);
+
+	FuncList &Same = Signatures[getSignatureKey(F)];
+	FuncList::iterator FI = std::find(Same.begin(), Same.end(), F);
+	if (FI != Same.end())
+		Same.erase(FI);
+	UseChains.clear();
+}
+
+void StructuredModuleEditor::moveCall(Instruction *Call, Function *From,
+		Function *To) {
+	if (From == To)
+		return;
+	if (From != NULL) {
+		InstList &List = CallSites[From];
+		InstList::iterator I = std::find(List.begin(), List.end(), Call);
+		if (I != List.end())
+			List.erase(I);
+	}
+	if (To != NULL)
+		CallSites[To].push_back(Call);
+	UseChains.clear();
+}
+
+StructuredModuleEditor::SignatureKey StructuredModuleEditor::getSignatureKey(
+		Function *F) {
+	FunctionType *FT = F->getFunctionType();
+	if (FT->isVarArg()) {
+		std::vector<Type*> Params(FT->param_begin(), FT->param_end());
+		FT = FunctionType::get(FT->getReturnType(), Params, false);
+	}
+	return SignatureKey(FT, F->getCallingConv());
 }
 
 StructuredModuleEditor::~StructuredModuleEditor() {
@@ -51,13 +182,7 @@ StructuredModuleEditor::FuncList* StructuredModuleEditor::getFuncsWithSameSignat
 		return NULL;
 	}
 
-	FuncList *MatchingFuncs = new FuncList;
-	for (Module::iterator FI = M->begin(), FE = M->end(); FI != FE; ++FI) {
-		if (signaturesMatch(Func, FI))
-			MatchingFuncs->push_back(FI);
-	}
-
-	return MatchingFuncs;
+	return new FuncList(Signatures[getSignatureKey(Func)]);
 }
 
 void StructuredModuleEditor::dumpFuncsWithSameSignature(StringRef FuncName) {
@@ -108,7 +233,10 @@ void StructuredModuleEditor::linkModule(Module *LinkMe) {
 	}
 
 	for (Module::iterator I = M->begin(), E = M->end(); I != E; ++I)
-		CG->getOrInsertFunction(I);
+		CG->addFunction(I);
+
+	// Linking can resolve declarations anywhere in the module.
+	buildIndices();
 }
 
 void StructuredModuleEditor::instrumentFunctionsThatCallFunction(
@@ -127,10 +255,11 @@ void StructuredModuleEditor::instrumentFunctionsThatCallFunction(
 	InstList Calls = getCallsToFunction(Callee);
 
 	FuncList Callers;
+	SmallPtrSet<Function*, 16> SeenCallers;
 	for (InstList::iterator II = Calls.begin(), IE = Calls.end(); II != IE;
 			++II) {
 		Function *Caller = (*II)->getParent()->getParent();
-		if (std::find(Callers.begin(), Callers.end(), Caller) == Callers.end())
+		if (SeenCallers.insert(Caller).second)
 			Callers.push_back(Caller);
 	}
 
@@ -149,6 +278,10 @@ void StructuredModuleEditor::instrumentFunctionsThatCallFunction(
 		std::vector<Type*> PreArgTypes;
 
 		Function *Caller = *FI;
+		if (Caller->isVarArg()) {
+			OS << "Skipping '" << Caller->getName() << "', which is variadic\n";
+			continue;
+		}
 
 		for (Function::arg_iterator AI = Caller->arg_begin(), AE =
 				Caller->arg_end(); AI != AE; ++AI) {
@@ -166,14 +299,18 @@ void StructuredModuleEditor::instrumentFunctionsThatCallFunction(
 						PreArgTypes, false));
 		Function *Pre = cast<Function>(PreConst);
 		Pre->setName("pre");
-		CG->getOrInsertFunction(Pre);
+		Instrumentation.insert(Pre);
+		CG->addFunction(Pre);
+		indexFunction(Pre);
 
 		Constant *PostConst = M->getOrInsertFunction("",
 				FunctionType::get(Type::getVoidTy(getGlobalContext()),
 						PostArgTypes, false));
 		Function *Post = cast<Function>(PostConst);
 		Post->setName("post");
-		CG->getOrInsertFunction(Post);
+		Instrumentation.insert(Post);
+		CG->addFunction(Post);
+		indexFunction(Post);
 
 		Function *Wrapper = wrapFunc(Caller, Pre, Post);
 		/*
@@ -208,14 +345,19 @@ void StructuredModuleEditor::instrumentCallsToFunction(Function *Callee) {
 		OS << "Function not found!\n";
 		return;
 	}
+	if (Callee->isVarArg()) {
+		OS << "Cannot wrap '" << Callee->getName() << "', which is variadic\n";
+		return;
+	}
 
 	InstList Calls = getCallsToFunction(Callee);
 
 	FuncList Callers;
+	SmallPtrSet<Function*, 16> SeenCallers;
 	for (InstList::iterator II = Calls.begin(), IE = Calls.end(); II != IE;
 			++II) {
 		Function *Caller = (*II)->getParent()->getParent();
-		if (std::find(Callers.begin(), Callers.end(), Caller) == Callers.end())
+		if (SeenCallers.insert(Caller).second)
 			Callers.push_back(Caller);
 	}
 
@@ -255,14 +397,18 @@ void StructuredModuleEditor::instrumentCallsToFunction(Function *Callee) {
 						PreArgTypes, false));
 		Function *Pre = cast<Function>(PreConst);
 		Pre->setName("pre");
-		CG->getOrInsertFunction(Pre);
+		Instrumentation.insert(Pre);
+		CG->addFunction(Pre);
+		indexFunction(Pre);
 
 		Constant *PostConst = M->getOrInsertFunction("",
 				FunctionType::get(Type::getVoidTy(getGlobalContext()),
 						PostArgTypes, false));
 		Function *Post = cast<Function>(PostConst);
 		Post->setName("post");
-		CG->getOrInsertFunction(Post);
+		Instrumentation.insert(Post);
+		CG->addFunction(Post);
+		indexFunction(Post);
 
 		/*
 		 OS << "\n";
@@ -278,33 +424,145 @@ void StructuredModuleEditor::instrumentCallsToFunction(Function *Callee) {
 			Callee = Wrapper;
 
 		Function *Caller = Callers.at(i);
-		for (Function::iterator BBI = Caller->begin(), BBE = Caller->end();
-				BBI != BBE; ++BBI) {
-			for (BasicBlock::iterator II = BBI->begin(), IE = BBI->end();
-					II != IE; ++II) {
-				CallSite CS(cast<Value>(II));
-				// If this isn't a call, or it is a call to an intrinsic...
-				if (!CS || isa<IntrinsicInst>(II))
-					continue;
+		InstList CalleeCalls = CallSites.lookup(Callee);
+		for (InstList::iterator II = CalleeCalls.begin(), IE = CalleeCalls.end();
+				II != IE; ++II) {
+			CallSite CS(cast<Value>(*II));
+			if (CS.getCaller() != Caller)
+				continue;
 
-				if (Callee == CS.getCalledFunction()) {
-					CS.setCalledFunction(Wrapper);
+			CS.setCalledFunction(Wrapper);
+			moveCall(CS.getInstruction(), Callee, Wrapper);
+			CG->updateCallEdge(CS);
+		}
+	}
 
-					// Creates an edge from the calling node to its new destination node
-					CallGraphNode *CallingNode = (*CG)[CS.getCaller()];
-					CallGraphNode *NewCalleeNode = (*CG)[Wrapper];
-					CallingNode->replaceCallEdge(CS, CS, NewCalleeNode);
-				}
-			}
+	OS << "Functions successfully wrapped!\n";
+}
+
+void StructuredModuleEditor::instrumentFunctionsThatCall(
+		const std::vector<Function*> &Callees) {
+	FuncList Callers;
+	planCallers(Callees, Callers);
+
+	OS << Callers.size() << " functions call the given functions...\n";
+	wrapAll(Callers);
+}
+
+void StructuredModuleEditor::instrumentFunctionsThatCall(FuncPredicate Pred) {
+	FuncList Callees;
+	selectFuncs(Pred, Callees);
+	instrumentFunctionsThatCall(Callees);
+}
+
+void StructuredModuleEditor::instrumentCallsTo(
+		const std::vector<Function*> &Callees) {
+	// Functions nobody calls are left alone.
+	FuncList Called;
+	SmallPtrSet<Function*, 16> Seen;
+	for (FuncList::const_iterator FI = Callees.begin(), FE = Callees.end();
+			FI != FE; ++FI) {
+		if (*FI != NULL && Seen.insert(*FI).second && CallSites.count(*FI))
+			Called.push_back(*FI);
+	}
+
+	OS << Called.size() << " of the given functions are called...\n";
+	wrapAll(Called);
+}
+
+void StructuredModuleEditor::instrumentCallsTo(FuncPredicate Pred) {
+	FuncList Callees;
+	selectFuncs(Pred, Callees);
+	instrumentCallsTo(Callees);
+}
+
+void StructuredModuleEditor::selectFuncs(FuncPredicate Pred,
+		FuncList &Funcs) {
+	for (Module::iterator I = M->begin(), E = M->end(); I != E; ++I)
+		if (Pred(I))
+			Funcs.push_back(I);
+}
+
+void StructuredModuleEditor::planCallers(const FuncList &Callees,
+		FuncList &Callers) {
+	SmallPtrSet<Function*, 16> SeenCallees;
+	SmallPtrSet<Function*, 16> SeenCallers;
+	for (FuncList::const_iterator FI = Callees.begin(), FE = Callees.end();
+			FI != FE; ++FI) {
+		if (*FI == NULL || !SeenCallees.insert(*FI).second)
+			continue;
+
+		DenseMap<Function*, InstList>::iterator Calls = CallSites.find(*FI);
+		if (Calls == CallSites.end())
+			continue;
+		for (InstList::iterator II = Calls->second.begin(), IE =
+				Calls->second.end(); II != IE; ++II) {
+			Function *Caller = (*II)->getParent()->getParent();
+			if (SeenCallers.insert(Caller).second)
+				Callers.push_back(Caller);
 		}
 	}
+}
+
+void StructuredModuleEditor::wrapAll(const FuncList &Funcs) {
+	// The wrapper and hooks take fixed arguments, so variadic functions
+	// (printf and the like, or fracture's placeholders) are left alone.
+	FuncList Wrappable;
+	OS << "=================================\n";
+	for (FuncList::const_iterator FI = Funcs.begin(), FE = Funcs.end();
+			FI != FE; ++FI) {
+		if ((*FI)->isVarArg()) {
+			OS << (*FI)->getName() << " (skipped, variadic)\n";
+			continue;
+		}
+		OS << (*FI)->getName() << "\n";
+		Wrappable.push_back(*FI);
+	}
+	OS << "=================================\n";
+
+	Type *VoidTy = Type::getVoidTy(getGlobalContext());
+	HookMap PreHooks, PostHooks;
+	for (FuncList::const_iterator FI = Wrappable.begin(), FE = Wrappable.end();
+			FI != FE; ++FI) {
+		Function *Original = *FI;
+
+		FunctionType *PreTy = FunctionType::get(VoidTy,
+				Original->getFunctionType()->params(), false);
+		std::vector<Type*> PostArgTypes;
+		if (!Original->getReturnType()->isVoidTy())
+			PostArgTypes.push_back(Original->getReturnType());
+		FunctionType *PostTy = FunctionType::get(VoidTy, PostArgTypes, false);
+
+		wrapFunc(Original, getHook("pre", PreTy, PreHooks),
+				getHook("post", PostTy, PostHooks));
+	}
 
+	OS << PreHooks.size() << " pre and " << PostHooks.size()
+			<< " post functions created\n";
 	OS << "Functions successfully wrapped!\n";
 }
 
+Function* StructuredModuleEditor::getHook(StringRef Name, FunctionType *Ty,
+		HookMap &Hooks) {
+	Function *&Hook = Hooks[Ty];
+	if (Hook != NULL)
+		return Hook;
+
+	Hook = cast<Function>(M->getOrInsertFunction("", Ty));
+	Hook->setName(Name);
+	Instrumentation.insert(Hook);
+	CG->addFunction(Hook);
+	indexFunction(Hook);
+	return Hook;
+}
+
 StructuredModuleEditor::ValueList StructuredModuleEditor::getUseChain(
 		Value *V) {
-	ValueList Vals;
+	DenseMap<Value*, ValueList>::iterator Cached = UseChains.find(V);
+	if (Cached != UseChains.end())
+		return Cached->second;
+
+	ValueList &Vals = UseChains[V];
 
 	for (Value::use_iterator UI = V->use_begin(), UE = V->use_end(); UI != UE;
 			++UI) {
@@ -338,6 +596,13 @@ Function* StructuredModuleEditor::wrapFunc(Function *OriginalFunc,
 	if (OriginalFunc == NULL)
 		return NULL;
 
+// The wrapper could only pass on the fixed arguments
+	if (OriginalFunc->isVarArg()) {
+		OS << "Cannot wrap '" << OriginalFunc->getName()
+				<< "', which is variadic\n";
+		return NULL;
+	}
+
 	if (PreFunc != NULL) {
 		for (Function::arg_iterator I = OriginalFunc->arg_begin(), J =
 				PreFunc->arg_begin(), E = OriginalFunc->arg_end(); I != E;
@@ -391,6 +656,7 @@ Function* StructuredModuleEditor::wrapFunc(Function *OriginalFunc,
 	Function *Wrapper = cast<Function>(c);
 
 	Wrapper->setName(OriginalFunc->getName() + "-wrapper");
+	Instrumentation.insert(Wrapper);
 
 // The Wrapper function uses the same calling convention as the wrappee.
 	Wrapper->setCallingConv(OriginalFunc->getCallingConv());
@@ -400,9 +666,6 @@ Function* StructuredModuleEditor::wrapFunc(Function *OriginalFunc,
 			OriginalFunc->arg_begin(), E = Wrapper->arg_end(); I != E; ++I, ++J)
 		I->setName(J->getName());
 
-// Inserts the Wrapper function into the CFG
-	CG->getOrInsertFunction(Wrapper);
-
 // Replaces all references to OriginalFunc with references to Wrapper
 	replaceFunc(OriginalFunc, Wrapper);
 
@@ -419,24 +682,16 @@ Function* StructuredModuleEditor::wrapFunc(Function *OriginalFunc,
 	IRBuilder<> builder(EntryBlock);
 
 	if (PreFunc != NULL) {
-		CallInst *PrologueCall = builder.CreateCall(PreFunc, WrapperArgs);
-		CallSite CS(PrologueCall);
-		(*CG)[Wrapper]->addCalledFunction(CS, (*CG)[PreFunc]);
+		builder.CreateCall(PreFunc, WrapperArgs);
 	}
 
 	CallInst *OriginalCall = builder.CreateCall(OriginalFunc, WrapperArgs);
-	CallSite CS(OriginalCall);
-	(*CG)[Wrapper]->addCalledFunction(CS, (*CG)[OriginalFunc]);
 
 	if (PostFunc != NULL) {
-		CallInst *EpilogueCall;
 		if (OriginalCall->getType()->isVoidTy())
-			EpilogueCall = builder.CreateCall(PostFunc);
+			builder.CreateCall(PostFunc);
 		else
-			EpilogueCall = builder.CreateCall(PostFunc, OriginalCall);
-
-		CallSite CS(EpilogueCall);
-		(*CG)[Wrapper]->addCalledFunction(CS, (*CG)[PostFunc]);
+			builder.CreateCall(PostFunc, OriginalCall);
 	}
 
 	if (OriginalCall->getType()->isVoidTy())
@@ -444,6 +699,10 @@ Function* StructuredModuleEditor::wrapFunc(Function *OriginalFunc,
 	else
 		builder.CreateRet(OriginalCall);
 
+// Adds the Wrapper function and the calls it makes to the CFG and the indices
+	CG->addFunction(Wrapper);
+	indexFunction(Wrapper);
+
 // Returns the Wrapper function we have created
 	return Wrapper;
 }
@@ -477,8 +736,8 @@ bool StructuredModuleEditor::replaceEdge(Function *Caller,
 
 // Sets the callsite's callee to the specified callee
 	CS.setCalledFunction(Destination);
-	CallGraphNode *DestinationNode = CG->getOrInsertFunction(Destination);
-	CG->getOrInsertFunction(Caller)->replaceCallEdge(CS, CS, DestinationNode);
+	moveCall(CS.getInstruction(), OldDestination, Destination);
+	CG->updateCallEdge(CS);
 	return true;
 }
 
@@ -495,6 +754,10 @@ bool StructuredModuleEditor::replaceFunc(Function *OldFunc, Function *NewFunc) {
 	if (OldFunc == NULL || NewFunc == NULL)
 		return false;
 
+// Nothing to move; going on would drop OldFunc's call sites from the index
+	if (OldFunc == NewFunc)
+		return true;
+
 	if (!signaturesMatch(OldFunc, NewFunc)) {
 		OS << "Cannot replace '" << OldFunc->getName() << "' with '"
 				<< NewFunc->getName()
@@ -504,6 +767,12 @@ bool StructuredModuleEditor::replaceFunc(Function *OldFunc, Function *NewFunc) {
 
 // Gathers all the calls to the function we want to bypass
 	InstList Calls = getCallsToFunction(OldFunc);
+	if (!Calls.empty()) {
+		InstList &NewCalls = CallSites[NewFunc];
+		NewCalls.insert(NewCalls.end(), Calls.begin(), Calls.end());
+		CallSites.erase(OldFunc);
+	}
+	UseChains.clear();
 
 // Iterates over each call to the function we want to bypass and sets the callee
 // to the function we want to hook
@@ -511,10 +780,8 @@ bool StructuredModuleEditor::replaceFunc(Function *OldFunc, Function *NewFunc) {
 		CallSite CS(cast<Value>(*I));
 		CS.setCalledFunction(NewFunc);
 
-// Creates an edge from the calling node to its new destination node
-		CallGraphNode *CallingNode = (*CG)[CS.getCaller()];
-		CallGraphNode *NewCalleeNode = (*CG)[NewFunc];
-		CallingNode->replaceCallEdge(CS, CS, NewCalleeNode);
+// Moves the edge from the calling node to its new destination node
+		CG->updateCallEdge(CS);
 	}
 
 // Replace all remaining uses of OldFunc with NewFunc (e.g. pointers)
@@ -536,40 +803,26 @@ bool StructuredModuleEditor::removeFunc(Function *FunctionToRemove) {
 		return false;
 	}
 
-	CallGraphNode *NodeToRemove = (*CG)[FunctionToRemove];
-
 	// We cannot remove a node if it has any inteprocedural in-edges
-	for (Module::iterator I = M->begin(), E = M->end(); I != E; ++I) {
-		CallGraphNode *CallingNode = (*CG)[I];
-		for (CallGraphNode::iterator CGNI = CallingNode->begin(), CGNE =
-				CallingNode->end(); CGNI != CGNE; ++CGNI) {
-			Function *Caller = I;
-			Function *Callee = CGNI->second->getFunction();
-			if (Callee == FunctionToRemove && Caller != Callee) {
-				OS << "Cannot remove " << FunctionToRemove->getName()
-						<< " because it has at least one interprocedural edge!\n";
-				OS << "It is called by " << Caller->getName() << "\n";
-				return false;
-			}
+	InstList Calls = CallSites.lookup(FunctionToRemove);
+	for (InstList::iterator I = Calls.begin(), E = Calls.end(); I != E; ++I) {
+		Function *Caller = (*I)->getParent()->getParent();
+		if (Caller != FunctionToRemove) {
+			OS << "Cannot remove " << FunctionToRemove->getName()
+					<< " because it has at least one interprocedural edge!\n";
+			OS << "It is called by " << Caller->getName() << "\n";
+			return false;
 		}
 	}
 
-// Removes all call graph edges from the node we are removing to its callees.
-	NodeToRemove->removeAllCalledFunctions();
-	CG->getExternalCallingNode()->removeAnyCallEdgeTo(NodeToRemove);
-
-// Removes all call graph edges from callees to the node we are removing
-	for (Module::iterator I = M->begin(), E = M->end(); I != E; ++I) {
-		CallGraphNode *CallingNode = (*CG)[I];
-		CallingNode->removeAnyCallEdgeTo(NodeToRemove);
-	}
-	NodeToRemove->removeAnyCallEdgeTo(CG->getCallsExternalNode());
-
-// Removes the function from the module and the CFG
+// Removes the function from the indices, and from the instrumentation so a
+// function created later at the same address is not taken for it
+	unindexFunction(FunctionToRemove);
+	Instrumentation.erase(FunctionToRemove);
 	FunctionToRemove->dropAllReferences();
 
-	// Remove the function from the module
-	CG->removeFunctionFromModule(NodeToRemove);
+// Removes the node and its edges from the CFG, and the function from the module
+	CG->removeFunction(FunctionToRemove);
 
 	return true;
 }
@@ -592,14 +845,8 @@ Function * StructuredModuleEditor::cloneFunc(Function * Original) {
 // Adds the clone to the Module
 	M->getFunctionList().push_back(Clone);
 
-// Adds the clone to the CFG
-	CG->getOrInsertFunction(Clone);
-
-// Adds each of the original function's CFG node's interprocedural out-edges
-// to the clone's node. All of the original function's intraprocedural in-edges are redirected to the cloned function.
-// The clone will have no interprocedural in-edges as it
-// was just created.
-	CallGraphNode *CloneNode = CG->getOrInsertFunction(Clone);
+// Redirects the original function's intraprocedural in-edges to the clone.
+// The clone will have no interprocedural in-edges as it was just created.
 	for (Function::iterator BBI = Clone->begin(), BBE = Clone->end();
 			BBI != BBE; ++BBI) {
 		for (BasicBlock::iterator II = BBI->begin(), IE = BBI->end(); II != IE;
@@ -609,16 +856,14 @@ Function * StructuredModuleEditor::cloneFunc(Function * Original) {
 			if (!CS || isa<IntrinsicInst>(II))
 				continue;
 
-			Function *Callee = CS.getCalledFunction();
-			if (Callee == Original) {
-				Callee = Clone;
+			if (CS.getCalledFunction() == Original)
 				CS.setCalledFunction(Clone);
-			}
-
-			CloneNode->addCalledFunction(CS, CG->getOrInsertFunction(Callee));
 		}
 	}
 
+// Adds the clone and its out-edges to the CFG and the indices
+	CG->addFunction(Clone);
+	indexFunction(Clone);
 	return Clone;
 }
 
@@ -674,37 +919,24 @@ bool StructuredModuleEditor::signaturesMatch(Function *First,
 
 StructuredModuleEditor::InstList StructuredModuleEditor::getCallsToFunction(
 		Function * F) {
-	InstList Calls;
-
-// Iterates over every basic block in the module and gathers a list of instructions
-// that call to the specified function
-	for (Module::iterator FI = M->begin(), FE = M->end(); FI != FE; ++FI) {
-		for (Function::iterator BBI = FI->begin(), BBE = FI->end(); BBI != BBE;
-				++BBI) {
-			for (BasicBlock::iterator II = BBI->begin(), IE = BBI->end();
-					II != IE; ++II) {
-				CallSite CS(cast<Value>(II));
-				// If this isn't a call, or it is a call to an intrinsic...
-				if (!CS || isa<IntrinsicInst>(II))
-					continue;
-
-				Function *Callee = CS.getCalledFunction();
-
-				if (Callee == F)
-					Calls.push_back(CS.getInstruction());
-			}
-		}
-	}
-
-	return Calls;
+	return CallSites.lookup(F);
 }
 
 void StructuredModuleEditor::removeChain(InstList &Chain) {
 	for (InstList::reverse_iterator I = Chain.rbegin(), E = Chain.rend();
 			I != E; ++I) {
+		// Calls are dropped from the index and the call graph first, so neither
+		// keeps a pointer to the erased instruction
+		CallSite CS(cast<Value>(*I));
+		if (CS && !isa<IntrinsicInst>(*I)) {
+			if (Function *Callee = CS.getCalledFunction())
+				moveCall(*I, Callee, NULL);
+			CG->removeCallEdge(CS);
+		}
 		(*I)->eraseFromParent();
 	}
 	Chain.clear();
+	UseChains.clear();
 }
 
 void StructuredModuleEditor::dumpInsts(InstList &Insts) {
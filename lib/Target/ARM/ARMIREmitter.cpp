@@ -44,12 +44,8 @@ Value* ARMIREmitter::visit(const SDNode *N) {
   IRB->SetCurrentDebugLocation(N->getDebugLoc());
   DEBUG(Infos << "Visiting ARM specific Opcode.\n");
   switch (N->getOpcode()) {
-	default: {
-		errs() << "OpCode: " << N->getOperationName(DAG) << "\n";
-		// dyn_cast<MachineSDNode>(N);
-		llvm_unreachable("ARMIREmitter::visit - Every ARM visit should be implemented...");
-		return NULL;
-	}
+	default:
+		return visitUnhandled(N);
     case ARMISD::Wrapper:				return visitWrapper(N);
     case ARMISD::WrapperPIC:			return visitWrapperPIC(N);
     case ARMISD::WrapperJT:				return visitWrapperJT(N);
@@ -177,10 +173,10 @@ Value* ARMIREmitter::visit(const SDNode *N) {
   }
 }
 
-Value* ARMIREmitter::visitWrapper(const SDNode *N) { llvm_unreachable("visitWrapper unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitWrapperPIC(const SDNode *N) { llvm_unreachable("visitWrapperPIC unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitWrapperJT(const SDNode *N) { llvm_unreachable("visitWrapperJT unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitCOPY_STRUCT_BYVAL(const SDNode *N) { llvm_unreachable("visitCOPY_STRUCT_BYVAL unimplemented ARM visit..."); return NULL; }
+Value* ARMIREmitter::visitWrapper(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitWrapperPIC(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitWrapperJT(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitCOPY_STRUCT_BYVAL(const SDNode *N) { return visitUnhandled(N); }
 
 Value* ARMIREmitter::visitCALL(const SDNode *N) {
   const ConstantSDNode *DestNode = dyn_cast<ConstantSDNode>(N->getOperand(0));
@@ -218,9 +214,9 @@ Value* ARMIREmitter::visitCALL(const SDNode *N) {
   return NULL;
 }
 
-Value* ARMIREmitter::visitCALL_PRED(const SDNode *N) { llvm_unreachable("visitCALL_PRED unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitCALL_NOLINK(const SDNode *N) { llvm_unreachable("visitCALL_NOLINK unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visittCALL(const SDNode *N) { llvm_unreachable("visittCALL unimplemented ARM visit..."); return NULL; }
+Value* ARMIREmitter::visitCALL_PRED(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitCALL_NOLINK(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visittCALL(const SDNode *N) { return visitUnhandled(N); }
 
 // Note: branch conditions, by definition, only have a chain user.
 // This is why it should not be saved in a map for recall.
@@ -269,89 +265,17 @@ Value* ARMIREmitter::visitBRCOND(const SDNode *N) {
   }
 
 
-  SDNode *CPSR = N->getOperand(2)->getOperand(1).getNode();
-  SDNode *CMPNode = NULL;
-  for (SDNode::use_iterator I = CPSR->use_begin(), E = CPSR->use_end(); I != E;
-       ++I) {
-    if (I->getOpcode() == ISD::CopyToReg) {
-      CMPNode = I->getOperand(2).getNode();
-    }
-  }
-
+  const SDNode *CMPNode = findFlagsNode(N->getOperand(2));
   if (CMPNode == NULL) {
     errs() << "ARMIREmitter ERROR: Could not find CMP SDNode for ARMBRCond!\n";
     return NULL;
   }
 
-  Value *Cmp = NULL;
-  Value *LHS = visit(CMPNode->getOperand(0).getNode());
-  Value *RHS = visit(CMPNode->getOperand(1).getNode());
-  // See ARMCC::CondCodes IntCCToARMCC(ISD::CondCode CC); in ARMISelLowering.cpp
-  // TODO: Add support for conditions that handle floating point
-  switch(ARMcc) {
-    default:
-      printError("Unknown condition code");
-      return NULL;
-    case ARMCC::EQ:
-      Cmp = IRB->CreateICmpEQ(LHS, RHS);
-      break;
-    case ARMCC::NE:
-      Cmp = IRB->CreateICmpNE(LHS, RHS);
-      break;
-    case ARMCC::HS:
-      // HS - unsigned higher or same (or carry set)
-      Cmp = IRB->CreateICmpUGE(LHS, RHS);
-      break;
-    case ARMCC::LO:
-      // LO - unsigned lower (or carry clear)
-      Cmp = IRB->CreateICmpULT(LHS, RHS);
-      break;
-    case ARMCC::MI:
-      // MI - minus (negative)
-      printError("Condition code MI is not handled at this time!");
-      return NULL;
-      // break;
-    case ARMCC::PL:
-      // PL - plus (positive or zero)
-      printError("Condition code PL is not handled at this time!");
-      return NULL;
-      // break;
-    case ARMCC::VS:
-      // VS - V Set (signed overflow)
-      printError("Condition code VS is not handled at this time!");
-      return NULL;
-      // break;
-    case ARMCC::VC:
-      // VC - V clear (no signed overflow)
-      printError("Condition code VC is not handled at this time!");
-      return NULL;
-      // break;
-    case ARMCC::HI:
-      // HI - unsigned higher
-      Cmp = IRB->CreateICmpUGT(LHS, RHS);
-      break;
-    case ARMCC::LS:
-      // LS - unsigned lower or same
-      Cmp = IRB->CreateICmpULE(LHS, RHS);
-      break;
-    case ARMCC::GE:
-      // GE - signed greater or equal
-      Cmp = IRB->CreateICmpSGE(LHS, RHS);
-      break;
-    case ARMCC::LT:
-      // LT - signed less than
-      Cmp = IRB->CreateICmpSLT(LHS, RHS);
-      break;
-    case ARMCC::GT:
-      // GT - signed greater than
-      Cmp = IRB->CreateICmpSGT(LHS, RHS);
-      break;
-    case ARMCC::LE:
-      // LE - signed less than or equal
-      Cmp = IRB->CreateICmpSLE(LHS, RHS);
-      break;
-  }
-  (dyn_cast<Instruction>(Cmp))->setDebugLoc(N->getOperand(2)->getDebugLoc());
+  Value *Cmp = getARMCondition(CMPNode, ARMcc);
+  if (Cmp == NULL)
+    return NULL;
+  if (Instruction *CmpInst = dyn_cast<Instruction>(Cmp))
+    CmpInst->setDebugLoc(N->getOperand(2)->getDebugLoc());
 
   // Conditional branch
   Instruction *Br = IRB->CreateCondBr(Cmp, BBTgt, NextBB);
@@ -359,134 +283,236 @@ Value* ARMIREmitter::visitBRCOND(const SDNode *N) {
   return Br;
 }
 
-Value* ARMIREmitter::visitBR_JT(const SDNode *N) { llvm_unreachable("visitBR_JT unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitBR2_JT(const SDNode *N) { llvm_unreachable("visitBR2_JT unimplemented ARM visit..."); return NULL; }
+Value* ARMIREmitter::visitBR_JT(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitBR2_JT(const SDNode *N) { return visitUnhandled(N); }
 
 Value* ARMIREmitter::visitRET_FLAG(const SDNode *N) {
   return IRB->CreateRetVoid();
 }
 
-Value* ARMIREmitter::visitINTRET_FLAG(const SDNode *N) { llvm_unreachable("visitINTRET_FLAG unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitPIC_ADD(const SDNode *N) { llvm_unreachable("visitPIC_ADD unimplemented ARM visit..."); return NULL; }
+Value* ARMIREmitter::visitINTRET_FLAG(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitPIC_ADD(const SDNode *N) { return visitUnhandled(N); }
+
+const SDNode* ARMIREmitter::findFlagsNode(SDValue CPSR) const {
+  // Consumers get CPSR either as a CopyFromReg or as the register itself.
+  const SDNode *Reg = CPSR.getNode();
+  if (CPSR.getOpcode() == ISD::CopyFromReg)
+    Reg = CPSR.getOperand(1).getNode();
+  if (Reg->getOpcode() != ISD::Register)
+    return Reg;
+
+  const SDNode *FlagsNode = NULL;
+  for (SDNode::use_iterator I = Reg->use_begin(), E = Reg->use_end(); I != E;
+       ++I) {
+    if (I->getOpcode() == ISD::CopyToReg) {
+      FlagsNode = I->getOperand(2).getNode();
+    }
+  }
+  return FlagsNode;
+}
+
+Value* ARMIREmitter::getARMCondition(const SDNode *FlagsNode,
+  unsigned ARMcc) {
+  // See ARMCC::CondCodes IntCCToARMCC(ISD::CondCode CC); in ARMISelLowering.cpp
+  // TODO: Add support for conditions that handle floating point
+  FlagCond Cond;
+  switch(ARMcc) {
+    default:
+      printError("Unknown condition code");
+      return NULL;
+    case ARMCC::AL:
+      return IRB->getTrue();
+    case ARMCC::EQ: Cond = FC_EQ;  break;
+    case ARMCC::NE: Cond = FC_NE;  break;
+    case ARMCC::HS: Cond = FC_UGE; break;   // unsigned higher or same
+    case ARMCC::LO: Cond = FC_ULT; break;   // unsigned lower
+    case ARMCC::MI: Cond = FC_MI;  break;   // minus (negative)
+    case ARMCC::PL: Cond = FC_PL;  break;   // plus (positive or zero)
+    case ARMCC::VS: Cond = FC_VS;  break;   // signed overflow
+    case ARMCC::VC: Cond = FC_VC;  break;   // no signed overflow
+    case ARMCC::HI: Cond = FC_UGT; break;   // unsigned higher
+    case ARMCC::LS: Cond = FC_ULE; break;   // unsigned lower or same
+    case ARMCC::GE: Cond = FC_SGE; break;
+    case ARMCC::LT: Cond = FC_SLT; break;
+    case ARMCC::GT: Cond = FC_SGT; break;
+    case ARMCC::LE: Cond = FC_SLE; break;
+  }
+  Value *Res = getFlagCondition(FlagsNode, Cond);
+  if (Res == NULL)
+    printError("ARMIREmitter: Condition does not come from a compare!");
+  return Res;
+}
 
+// The compares only record their operands; see IREmitter::getFlagCondition.
 Value* ARMIREmitter::visitCMP(const SDNode *N) {
-	//errs() << "visitCMP unimplemented ARM visit...\n";
-	//return NULL;
-  
-    //Presuming the ARM version will work something like X86...
-    //cmp     r0, #0x0
-    //beq     #-0x14
-    return IREmitter::visitSUB(N);
+  //cmp     r0, #0x0
+  //beq     #-0x14
+  recordFlags(N, LazyFlags::Sub, visit(N->getOperand(0).getNode()),
+    visit(N->getOperand(1).getNode()));
+  return NULL;
+}
+
+Value* ARMIREmitter::visitCMN(const SDNode *N) {
+  // Sets the flags of Rn + Op2.
+  recordFlags(N, LazyFlags::Add, visit(N->getOperand(0).getNode()),
+    visit(N->getOperand(1).getNode()));
+  return NULL;
+}
+
+Value* ARMIREmitter::visitCMPZ(const SDNode *N) {
+  // A CMP whose users only test Z.
+  recordFlags(N, LazyFlags::Sub, visit(N->getOperand(0).getNode()),
+    visit(N->getOperand(1).getNode()));
+  return NULL;
+}
+
+Value* ARMIREmitter::visitCMPFP(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitCMPFPw0(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitFMSTAT(const SDNode *N) { return visitUnhandled(N); }
+
+Value* ARMIREmitter::visitCMOV(const SDNode *N) {
+  // Operand 0 - False value
+  // Operand 1 - True value
+  // Operand 2 - Condition code
+  // Operand 3 - CPSR
+  const ConstantSDNode *CCNode = dyn_cast<ConstantSDNode>(N->getOperand(2));
+  if (!CCNode) {
+    printError("visitCMOV: Condition code is not a constant integer!");
+    return NULL;
+  }
+  ARMCC::CondCodes ARMcc = ARMCC::CondCodes(CCNode->getZExtValue());
+
+  Value *FalseVal = visit(N->getOperand(0).getNode());
+  Value *TrueVal = visit(N->getOperand(1).getNode());
+  if (FalseVal == NULL || TrueVal == NULL) {
+    printError("visitCMOV: Null operand values!");
+    return NULL;
+  }
+  Value *Cmp = NULL;
+  if (ARMcc == ARMCC::AL) {
+    Cmp = IRB->getTrue();
+  } else if (const SDNode *FlagsNode = findFlagsNode(N->getOperand(3))) {
+    Cmp = getARMCondition(FlagsNode, ARMcc);
+  }
+  if (Cmp == NULL) {
+    printError("visitCMOV: Could not compute the condition!");
+    return NULL;
+  }
+
+  StringRef BaseName = getInstructionName(N);
+  if (BaseName.empty()) {
+    BaseName = getBaseValueName(FalseVal->getName());
+  }
+  StringRef Name = getIndexedValueName(BaseName);
+  Value *Res = IRB->CreateSelect(Cmp, TrueVal, FalseVal, Name);
+  if (Instruction *ResInst = dyn_cast<Instruction>(Res))
+    ResInst->setDebugLoc(N->getDebugLoc());
+  VisitMap[N] = Res;
+  return Res;
 }
 
-Value* ARMIREmitter::visitCMN(const SDNode *N) { llvm_unreachable("visitCMN unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitCMPZ(const SDNode *N) { llvm_unreachable("visitCMPZ unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitCMPFP(const SDNode *N) { llvm_unreachable("visitCMPFP unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitCMPFPw0(const SDNode *N) { llvm_unreachable("visitCMPFPw0 unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitFMSTAT(const SDNode *N) { llvm_unreachable("visitFMSTAT unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitCMOV(const SDNode *N) { llvm_unreachable("visitCMOV unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitBCC_i64(const SDNode *N) { llvm_unreachable("visitBCC_i64 unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitRBIT(const SDNode *N) { llvm_unreachable("visitRBIT unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitFTOSI(const SDNode *N) { llvm_unreachable("visitFTOSI unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitFTOUI(const SDNode *N) { llvm_unreachable("visitFTOUI unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitSITOF(const SDNode *N) { llvm_unreachable("visitSITOF unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitUITOF(const SDNode *N) { llvm_unreachable("visitUITOF unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitSRL_FLAG(const SDNode *N) { llvm_unreachable("visitSRL_FLAG unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitSRA_FLAG(const SDNode *N) { llvm_unreachable("visitSRA_FLAG unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitRRX(const SDNode *N) { llvm_unreachable("visitRRX unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitADDC(const SDNode *N) { llvm_unreachable("visitADDC unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitADDE(const SDNode *N) { llvm_unreachable("visitADDE unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitSUBC(const SDNode *N) { llvm_unreachable("visitSUBC unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitSUBE(const SDNode *N) { llvm_unreachable("visitSUBE unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitVMOVRRD(const SDNode *N) { llvm_unreachable("visitVMOVRRD unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitVMOVDRR(const SDNode *N) { llvm_unreachable("visitVMOVDRR unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitEH_SJLJ_SETJMP(const SDNode *N) { llvm_unreachable("visitEH_SJLJ_SETJMP unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitEH_SJLJ_LONGJMP(const SDNode *N) { llvm_unreachable("visitEH_SJLJ_LONGJMP unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitTC_RETURN(const SDNode *N) { llvm_unreachable("visitTC_RETURN unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitTHREAD_POINTER(const SDNode *N) { llvm_unreachable("visitTHREAD_POINTER unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitDYN_ALLOC(const SDNode *N) { llvm_unreachable("visitDYN_ALLOC unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitMEMBARRIER_MCR(const SDNode *N) { llvm_unreachable("visitMEMBARRIER_MCR unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitPRELOAD(const SDNode *N) { llvm_unreachable("visitPRELOAD unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitVCEQ(const SDNode *N) { llvm_unreachable("visitVCEQ unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitVCEQZ(const SDNode *N) { llvm_unreachable("visitVCEQZ unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitVCGE(const SDNode *N) { llvm_unreachable("visitVCGE unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitVCGEZ(const SDNode *N) { llvm_unreachable("visitVCGEZ unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitVCLEZ(const SDNode *N) { llvm_unreachable("visitVCLEZ unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitVCGEU(const SDNode *N) { llvm_unreachable("visitVCGEU unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitVCGT(const SDNode *N) { llvm_unreachable("visitVCGT unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitVCGTZ(const SDNode *N) { llvm_unreachable("visitVCGTZ unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitVCLTZ(const SDNode *N) { llvm_unreachable("visitVCLTZ unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitVCGTU(const SDNode *N) { llvm_unreachable("visitVCGTU unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitVTST(const SDNode *N) { llvm_unreachable("visitVTST unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitVSHL(const SDNode *N) { llvm_unreachable("visitVSHL unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitVSHRs(const SDNode *N) { llvm_unreachable("visitVSHRs unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitVSHRu(const SDNode *N) { llvm_unreachable("visitVSHRu unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitVSHLLs(const SDNode *N) { llvm_unreachable("visitVSHLLs unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitVSHLLu(const SDNode *N) { llvm_unreachable("visitVSHLLu unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitVSHLLi(const SDNode *N) { llvm_unreachable("visitVSHLLi unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitVSHRN(const SDNode *N) { llvm_unreachable("visitVSHRN unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitVRSHRs(const SDNode *N) { llvm_unreachable("visitVRSHRs unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitVRSHRu(const SDNode *N) { llvm_unreachable("visitVRSHRu unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitVRSHRN(const SDNode *N) { llvm_unreachable("visitVRSHRN unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitVQSHLs(const SDNode *N) { llvm_unreachable("visitVQSHLs unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitVQSHLu(const SDNode *N) { llvm_unreachable("visitVQSHLu unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitVQSHLsu(const SDNode *N) { llvm_unreachable("visitVQSHLsu unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitVQSHRNs(const SDNode *N) { llvm_unreachable("visitVQSHRNs unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitVQSHRNu(const SDNode *N) { llvm_unreachable("visitVQSHRNu unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitVQSHRNsu(const SDNode *N) { llvm_unreachable("visitVQSHRNsu unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitVQRSHRNs(const SDNode *N) { llvm_unreachable("visitVQRSHRNs unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitVQRSHRNu(const SDNode *N) { llvm_unreachable("visitVQRSHRNu unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitVQRSHRNsu(const SDNode *N) { llvm_unreachable("visitVQRSHRNsu unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitVSLI(const SDNode *N) { llvm_unreachable("visitVSLI unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitVSRI(const SDNode *N) { llvm_unreachable("visitVSRI unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitVGETLANEu(const SDNode *N) { llvm_unreachable("visitVGETLANEu unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitVGETLANEs(const SDNode *N) { llvm_unreachable("visitVGETLANEs unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitVMOVIMM(const SDNode *N) { llvm_unreachable("visitVMOVIMM unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitVMVNIMM(const SDNode *N) { llvm_unreachable("visitVMVNIMM unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitVMOVFPIMM(const SDNode *N) { llvm_unreachable("visitVMOVFPIMM unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitVDUP(const SDNode *N) { llvm_unreachable("visitVDUP unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitVDUPLANE(const SDNode *N) { llvm_unreachable("visitVDUPLANE unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitVEXT(const SDNode *N) { llvm_unreachable("visitVEXT unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitVREV64(const SDNode *N) { llvm_unreachable("visitVREV64 unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitVREV32(const SDNode *N) { llvm_unreachable("visitVREV32 unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitVREV16(const SDNode *N) { llvm_unreachable("visitVREV16 unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitVZIP(const SDNode *N) { llvm_unreachable("visitVZIP unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitVUZP(const SDNode *N) { llvm_unreachable("visitVUZP unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitVTRN(const SDNode *N) { llvm_unreachable("visitVTRN unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitVTBL1(const SDNode *N) { llvm_unreachable("visitVTBL1 unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitVTBL2(const SDNode *N) { llvm_unreachable("visitVTBL2 unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitVMULLs(const SDNode *N) { llvm_unreachable("visitVMULLs unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitVMULLu(const SDNode *N) { llvm_unreachable("visitVMULLu unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitUMLAL(const SDNode *N) { llvm_unreachable("visitUMLAL unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitSMLAL(const SDNode *N) { llvm_unreachable("visitSMLAL unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitBUILD_VECTOR(const SDNode *N) { llvm_unreachable("visitBUILD_VECTOR unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitFMAX(const SDNode *N) { llvm_unreachable("visitFMAX unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitFMIN(const SDNode *N) { llvm_unreachable("visitFMIN unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitVMAXNM(const SDNode *N) { llvm_unreachable("visitVMAXNM unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitVMINNM(const SDNode *N) { llvm_unreachable("visitVMINNM unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitBFI(const SDNode *N) { llvm_unreachable("visitBFI unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitVORRIMM(const SDNode *N) { llvm_unreachable("visitVORRIMM unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitVBICIMM(const SDNode *N) { llvm_unreachable("visitVBICIMM unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitVBSL(const SDNode *N) { llvm_unreachable("visitVBSL unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitVLD2DUP(const SDNode *N) { llvm_unreachable("visitVLD2DUP unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitVLD3DUP(const SDNode *N) { llvm_unreachable("visitVLD3DUP unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitVLD4DUP(const SDNode *N) { llvm_unreachable("visitVLD4DUP unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitVLD1_UPD(const SDNode *N) { llvm_unreachable("visitVLD1_UPD unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitVLD2_UPD(const SDNode *N) { llvm_unreachable("visitVLD2_UPD unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitVLD3_UPD(const SDNode *N) { llvm_unreachable("visitVLD3_UPD unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitVLD4_UPD(const SDNode *N) { llvm_unreachable("visitVLD4_UPD unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitVLD2LN_UPD(const SDNode *N) { llvm_unreachable("visitVLD2LN_UPD unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitVLD3LN_UPD(const SDNode *N) { llvm_unreachable("visitVLD3LN_UPD unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitVLD4LN_UPD(const SDNode *N) { llvm_unreachable("visitVLD4LN_UPD unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitVLD2DUP_UPD(const SDNode *N) { llvm_unreachable("visitVLD2DUP_UPD unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitVLD3DUP_UPD(const SDNode *N) { llvm_unreachable("visitVLD3DUP_UPD unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitVLD4DUP_UPD(const SDNode *N) { llvm_unreachable("visitVLD4DUP_UPD unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitVST1_UPD(const SDNode *N) { llvm_unreachable("visitVST1_UPD unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitVST2_UPD(const SDNode *N) { llvm_unreachable("visitVST2_UPD unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitVST3_UPD(const SDNode *N) { llvm_unreachable("visitVST3_UPD unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitVST4_UPD(const SDNode *N) { llvm_unreachable("visitVST4_UPD unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitVST2LN_UPD(const SDNode *N) { llvm_unreachable("visitVST2LN_UPD unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitVST3LN_UPD(const SDNode *N) { llvm_unreachable("visitVST3LN_UPD unimplemented ARM visit..."); return NULL; }
-Value* ARMIREmitter::visitVST4LN_UPD(const SDNode *N) { llvm_unreachable("visitVST4LN_UPD unimplemented ARM visit..."); return NULL; }
+Value* ARMIREmitter::visitBCC_i64(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitRBIT(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitFTOSI(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitFTOUI(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitSITOF(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitUITOF(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitSRL_FLAG(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitSRA_FLAG(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitRRX(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitADDC(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitADDE(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitSUBC(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitSUBE(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitVMOVRRD(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitVMOVDRR(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitEH_SJLJ_SETJMP(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitEH_SJLJ_LONGJMP(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitTC_RETURN(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitTHREAD_POINTER(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitDYN_ALLOC(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitMEMBARRIER_MCR(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitPRELOAD(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitVCEQ(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitVCEQZ(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitVCGE(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitVCGEZ(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitVCLEZ(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitVCGEU(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitVCGT(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitVCGTZ(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitVCLTZ(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitVCGTU(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitVTST(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitVSHL(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitVSHRs(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitVSHRu(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitVSHLLs(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitVSHLLu(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitVSHLLi(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitVSHRN(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitVRSHRs(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitVRSHRu(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitVRSHRN(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitVQSHLs(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitVQSHLu(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitVQSHLsu(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitVQSHRNs(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitVQSHRNu(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitVQSHRNsu(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitVQRSHRNs(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitVQRSHRNu(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitVQRSHRNsu(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitVSLI(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitVSRI(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitVGETLANEu(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitVGETLANEs(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitVMOVIMM(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitVMVNIMM(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitVMOVFPIMM(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitVDUP(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitVDUPLANE(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitVEXT(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitVREV64(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitVREV32(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitVREV16(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitVZIP(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitVUZP(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitVTRN(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitVTBL1(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitVTBL2(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitVMULLs(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitVMULLu(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitUMLAL(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitSMLAL(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitBUILD_VECTOR(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitFMAX(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitFMIN(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitVMAXNM(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitVMINNM(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitBFI(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitVORRIMM(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitVBICIMM(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitVBSL(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitVLD2DUP(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitVLD3DUP(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitVLD4DUP(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitVLD1_UPD(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitVLD2_UPD(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitVLD3_UPD(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitVLD4_UPD(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitVLD2LN_UPD(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitVLD3LN_UPD(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitVLD4LN_UPD(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitVLD2DUP_UPD(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitVLD3DUP_UPD(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitVLD4DUP_UPD(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitVST1_UPD(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitVST2_UPD(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitVST3_UPD(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitVST4_UPD(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitVST2LN_UPD(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitVST3LN_UPD(const SDNode *N) { return visitUnhandled(N); }
+Value* ARMIREmitter::visitVST4LN_UPD(const SDNode *N) { return visitUnhandled(N); }
 
 } // end fracture namespace
@@ -467,49 +467,85 @@ SDNode* X86InvISelDAG::Transmogrify(SDNode *N) {
       return NULL;
       break;
     }
-    case X86::JLE_1:    //Need to add to IREMitter...
+    case X86::JLE_1:{
+      /**<
+       * JLE_1 - Jump if Less or Equal
+       */
+
+      JumpOnCondition(N, ISD::SETLE);
+
+      return NULL;
+      break;
+    }
     case X86::JBE_4:
     case X86::JBE_1:{
       /**<
        * JBE_1 - Jump if Below or Equal
        */
 
-      JumpOnCondition(N, ISD::SETLE);
+      JumpOnCondition(N, ISD::SETULE);
+
+      return NULL;
+      break;
+    }
+    case X86::JL_1:{
+      /**<
+       * JL_1 - Jump if Less
+       */
+
+      JumpOnCondition(N, ISD::SETLT);
 
       return NULL;
       break;
     }
-    case X86::JL_1:     //Need to add to IREMitter...
     case X86::JB_1:{
       /**<
        * JB_1 - Jump if Below
        */
 
-      JumpOnCondition(N, ISD::SETLT);
+      JumpOnCondition(N, ISD::SETULT);
+
+      return NULL;
+      break;
+    }
+    case X86::JGE_1:{
+      /**<
+       * JGE_1 - Jump if Greater or Equal
+       */
+
+      JumpOnCondition(N, ISD::SETGE);
 
       return NULL;
       break;
     }
-    case X86::JGE_1:    //Need to add to IREMitter...
     case X86::JAE_4:
     case X86::JAE_1:{
       /**<
        * JAE_1 - Jump if Above or Equal
        */
 
-      JumpOnCondition(N, ISD::SETGE);
+      JumpOnCondition(N, ISD::SETUGE);
+
+      return NULL;
+      break;
+    }
+    case X86::JG_1:{
+      /**<
+       * JG_1 - Jump if Greater
+       */
+
+      JumpOnCondition(N, ISD::SETGT);
 
       return NULL;
       break;
     }
-    case X86::JG_1:     //Need to add to IREMitter...
     case X86::JA_4:
     case X86::JA_1:{
       /**<
        * JA_1 - Jump if Above
        */
 
-      JumpOnCondition(N, ISD::SETGT);
+      JumpOnCondition(N, ISD::SETUGT);
 
       return NULL;
       break;
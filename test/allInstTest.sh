@@ -56,6 +56,15 @@ $triple">results.txt
 date>>results.txt
 hostname>>results.txt
 
+#Without per instruction debug output, run every binary in one fracture-batch
+#process (pre-forked workers, targets initialized once) when it is installed.
+if [[ $debug = no ]] && command -v fracture-batch >/dev/null 2>&1
+then
+	binaries=$(ls -1d ../$targetdir* | wc -l)
+	fracture-batch -inst-test -label=$target -mattr=$n -triple=$triple \
+		-summary=results.txt ../$targetdir*
+else
+
 #Look through each file in the targetdir and run it through fracture, recording the results to #ircode.tmp
 
 for fn in ../$targetdir*; 
@@ -117,6 +126,7 @@ quit" | fracture -mattr=$n -triple=$triple $fn&>ircode.tmp
 		printf "SUCCESS,$f\n">>results.txt
 	fi
 done
+fi
 #Print resulting statistics to file and screen
 printf "Total binaries, $binaries">> results.txt
 printf "\nTotal segmentation faults or aborts, ">>results.txt
@@ -0,0 +1,37 @@
+; Every streamed file defines one function, so the directory links back into
+; a single module.
+; RUN: llc -filetype=obj -march=arm -mattr=v6 -o %t1 < %s
+; RUN: rm -rf %t.dir
+; RUN: sed -e 's|@DIR@|%t.dir|' %S/stream-arm.cmds \
+; RUN:   | fracture-cl -arch=arm -mattr=v6 %t1 > /dev/null
+; RUN: llvm-link -S -o %t2 %t.dir/00000-add3.ll %t.dir/00001-sub5.ll \
+; RUN:   %t.dir/globals.ll
+; RUN: FileCheck %s < %t2
+; RUN: FileCheck -check-prefix=ONE %s < %t.dir/00000-add3.ll
+; RUN: FileCheck -check-prefix=TWO %s < %t.dir/00001-sub5.ll
+
+; CHECK-DAG: define {{.*}}@add3(
+; CHECK-DAG: define {{.*}}@sub5(
+
+; ONE-NOT: define {{.*}}@sub5(
+; ONE: define {{.*}}@add3(
+; ONE-NOT: define {{.*}}@sub5(
+
+; TWO-NOT: define {{.*}}@add3(
+; TWO: define {{.*}}@sub5(
+; TWO-NOT: define {{.*}}@add3(
+
+target datalayout = "e-m:e-p:32:32-i64:64-v128:64:128-a:0:32-n32-S64"
+target triple = "armv6-unknown-linux-gnueabi"
+
+define i32 @add3(i32 %a) nounwind {
+entry:
+  %r = add i32 %a, 3
+  ret i32 %r
+}
+
+define i32 @sub5(i32 %a) nounwind {
+entry:
+  %r = sub i32 %a, 5
+  ret i32 %r
+}
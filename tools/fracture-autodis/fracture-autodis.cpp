@@ -16,6 +16,10 @@
 // 4. Print the instruction mnemonic and frequency of 1 (aggregation happens
 //    during reduce step.
 //
+// With -histogram (or -histogram-out) the counts are aggregated in-process
+// instead, and printed as one line per opcode (or saved in a binary format).
+// Saved histograms from many runs are combined with -merge-histogram.
+//
 // NOTE: We hardcode a bunch of variables for this to work appropriately, and it
 // does not automatically recursively decend the binary.
 //
@@ -71,6 +75,7 @@
 #include "CodeInv/Disassembler.h"
 #include "CodeInv/InvISelDAG.h"
 #include "CodeInv/MCDirector.h"
+#include "CodeInv/OpcodeHistogram.h"
 #include "Commands/Commands.h"
 
 //#define DEMANGLE  // Do name demangling
@@ -112,6 +117,17 @@ static cl::opt<bool> ViewMachineDAGs("view-machine-dags", cl::Hidden,
 static cl::opt<bool> ViewIRDAGs("view-ir-dags", cl::Hidden,
     cl::desc("Pop up a window to show dags after Inverse DAG Select."));
 
+static cl::opt<bool> Histogram("histogram",
+    cl::desc("Count instructions in-process and print one line per opcode."));
+
+static cl::opt<std::string> HistogramOut("histogram-out",
+    cl::desc("Save the instruction counts as a mergeable binary histogram."),
+    cl::value_desc("filename"));
+
+static cl::list<std::string> MergeHistograms("merge-histogram",
+    cl::desc("Merge saved histograms and print (or save) the total, "
+        "without reading a binary."), cl::value_desc("filename"));
+
 static bool error(error_code ec) {
   if (!ec)
     return false;
@@ -762,6 +778,26 @@ int main(int argc, char *argv[]) {
 
   initializeCommands();
 
+  // Reduce step over saved histograms
+  if (!MergeHistograms.empty()) {
+    OpcodeHistogram Merged;
+    for (unsigned i = 0, e = MergeHistograms.size(); i != e; ++i) {
+      if (std::error_code Err = Merged.read(MergeHistograms[i])) {
+        errs() << ProgramName << ": Could not read histogram '"
+               << MergeHistograms[i] << "'. " << Err.message() << ".\n";
+        return -1;
+      }
+    }
+    if (HistogramOut.empty()) {
+      Merged.print(outs());
+    } else if (std::error_code Err = Merged.write(HistogramOut)) {
+      errs() << ProgramName << ": Could not write histogram. "
+             << Err.message() << ".\n";
+      return -1;
+    }
+    return 0;
+  }
+
   // Step 1, load binary
   if (error_code Err = loadBinary("-")) {
     errs() << ProgramName << ": Could not open stdin file!'"
@@ -774,6 +810,8 @@ int main(int argc, char *argv[]) {
   CL.push_back("sym");
   CL.push_back(".text");
   std::vector<object::SymbolRef> Symbols = runSymbolsCommand(CL);
+  bool Aggregate = Histogram || !HistogramOut.empty();
+  OpcodeHistogram Counts(DAS->getMCDirector()->getMCInstrInfo());
   // Step 3: Get list of each instruction for that function
   for (unsigned i = 0, e = Symbols.size(); i != e; ++i) {
     uint64_t SymAddr;
@@ -801,7 +839,10 @@ int main(int argc, char *argv[]) {
     // Print each instruction
     while (BI != BE && BI->size() > 0) {
       // printInstruction(Out, II, PrintTypes);
-      outs() << DAS->getMCDirector()->getMCInstrInfo()->getName(
+      if (Aggregate)
+        Counts.count(II->getOpcode());
+      else
+        outs() << DAS->getMCDirector()->getMCInstrInfo()->getName(
 						    II->getOpcode()) << "\t1\n";
       ++II;
       if (II == IE) {
@@ -813,6 +854,16 @@ int main(int argc, char *argv[]) {
     DAS->deleteFunction(MF);
   }
 
+  if (!HistogramOut.empty()) {
+    if (std::error_code Err = Counts.write(HistogramOut)) {
+      errs() << ProgramName << ": Could not write histogram. "
+             << Err.message() << ".\n";
+      return -1;
+    }
+  } else if (Histogram) {
+    Counts.print(outs());
+  }
+
   errs() << "reporter:counter:SkippingTaskCounters,MapProcessedRecords,1\n";
 
   return 0;
@@ -0,0 +1,535 @@
+//===--- fracture-batch.cpp - Batch Decompiler ------------------*- C++ -*-===//
+//
+//              Fracture: The Draper Decompiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Decompiles every binary listed in a manifest, without the interactive
+// shell. Targets are initialized once, the binaries run on a pool of forked
+// workers (see BatchRunner) that keep one MCDirector per triple, and a JSON
+// summary with the status and time of every binary is written at the end.
+//
+// Manifest format: one binary per line, optionally followed by a triple.
+// Blank lines and lines starting with '#' are ignored.
+//
+// With -inst-test the inputs are single instruction binaries instead (see
+// test/allInstTest.sh and mkAllInsts). Each one is decompiled at 0x0 and
+// classified the way allInstTest.sh does, and its results CSV is written.
+//
+// With -o the module of every binary is saved, as bitcode with -emit-bc.
+// -stream writes each function to its own file under -o as soon as it is
+// decompiled and drops it (see FunctionStreamer), and -memory-budget frees
+// the decoded machine code of finished functions, so large binaries lift in
+// bounded memory. -opt runs a pass pipeline, built once per worker, over
+// every function before it is saved.
+//
+// With -stats the summary also holds the decompiler timers and counters (see
+// Metrics) of every binary. With -coverage, nodes the decompiler has no
+// lowering for are recorded instead of aborting the binary, and the summary
+// ranks them over all binaries (see CoverageProfile).
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/Triple.h"
+#include "llvm/IR/Module.h"
+#include "llvm/MC/SubtargetFeature.h"
+#include "llvm/Object/Binary.h"
+#include "llvm/Object/ObjectFile.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/ManagedStatic.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/PrettyStackTrace.h"
+#include "llvm/Support/Signals.h"
+#include "llvm/Support/TargetRegistry.h"
+#include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/Timer.h"
+#include "llvm/Target/TargetOptions.h"
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "DummyObjectFile.h"
+#include "CodeInv/BatchRunner.h"
+#include "CodeInv/CoverageProfile.h"
+#include "CodeInv/Decompiler.h"
+#include "CodeInv/Disassembler.h"
+#include "CodeInv/FunctionDiscovery.h"
+#include "CodeInv/JSONWriter.h"
+#include "CodeInv/MCDirectorRegistry.h"
+#include "CodeInv/Metrics.h"
+#include "CodeInv/ModuleWriter.h"
+#include "CodeInv/OptPipeline.h"
+
+using namespace llvm;
+using namespace fracture;
+
+//===----------------------------------------------------------------------===//
+// Global Variables and Parameters
+//===----------------------------------------------------------------------===//
+static std::string ProgramName;
+
+// Per worker state, reused across the binaries the worker runs.
+static MCDirectorRegistry *Directors = 0;
+static MCDirector *MCD = 0;
+static Disassembler *DAS = 0;
+static Decompiler *DEC = 0;
+static CoverageProfile Coverage;
+static OptPipeline Optimizer;
+// Disassembler errors of the current binary.
+static std::string DisasErrors;
+static raw_string_ostream DisasErrorsOut(DisasErrors);
+
+struct BatchEntry {
+  std::string FileName;
+  std::string TripleName;
+};
+
+//Command Line Options
+static cl::list<std::string> Inputs(cl::Positional, cl::OneOrMore,
+    cl::desc("<manifest>... or, with -inst-test, <binary>..."));
+
+static cl::opt<std::string> TripleName("triple",
+    cl::desc("Target triple for binaries without one in the manifest "
+        "(default: from the binary)"));
+
+static cl::list<std::string> MAttrs("mattr", cl::CommaSeparated,
+    cl::desc("Target specific attributes"), cl::value_desc("a1,+a2,-a3,..."));
+
+static cl::opt<unsigned> NumJobs("j",
+    cl::desc("Number of worker processes, 0 runs in-process (default: "
+        "number of cores)"), cl::init(std::thread::hardware_concurrency()));
+
+static cl::opt<unsigned> Timeout("timeout",
+    cl::desc("Seconds allowed per binary, 0 for no limit"), cl::init(300));
+
+static cl::opt<std::string> OutputDir("o",
+    cl::desc("Directory to save the decompiled module of each binary to"),
+    cl::value_desc("directory"));
+
+static cl::opt<bool> RegSSA("reg-ssa",
+    cl::desc("Emit registers as SSA values instead of loads and stores of "
+        "globals"));
+
+static cl::opt<bool> Optimize("opt",
+    cl::desc("Optimize every decompiled function with mem2reg, instcombine, "
+        "simplifycfg and dce"));
+
+static cl::opt<std::string> OptPasses("opt-passes",
+    cl::desc("Comma separated passes to optimize every decompiled function "
+        "with, instead of the -opt ones"), cl::value_desc("passes"));
+
+static cl::opt<unsigned> MemoryBudget("memory-budget",
+    cl::desc("Free the machine code of decompiled functions once it takes "
+        "more than this many MB, 0 for no limit"), cl::init(0));
+
+static cl::opt<bool> EmitBitcode("emit-bc",
+    cl::desc("Save modules as bitcode instead of textual IR"));
+
+static cl::opt<bool> StreamFunctions("stream",
+    cl::desc("Save every function to its own file in -o/<binary>/ as soon "
+        "as it is decompiled, and drop it from memory"));
+
+static cl::opt<std::string> SummaryName("summary",
+    cl::desc("File to write the JSON summary to (default: stdout)"),
+    cl::value_desc("filename"), cl::init("-"));
+
+static cl::opt<bool> InstTest("inst-test",
+    cl::desc("Decompile single instruction binaries at 0x0 and append "
+        "allInstTest.sh style CSV results to the summary file"));
+
+static cl::opt<bool> CollectStats("stats",
+    cl::desc("Add the decompiler timers and counters of each binary to the "
+        "JSON summary"));
+
+static cl::opt<bool> CoverageMode("coverage",
+    cl::desc("Record unhandled nodes instead of aborting, and rank them in "
+        "the JSON summary"));
+
+static cl::opt<std::string> InstTestLabel("label",
+    cl::desc("Target label of -inst-test result lines (default: arch)"));
+
+///===---------------------------------------------------------------------===//
+/// readManifest    - Reads the binaries (and optional triples) to run.
+///
+static std::error_code readManifest(StringRef FileName,
+  std::vector<BatchEntry> &Entries) {
+  ErrorOr<std::unique_ptr<MemoryBuffer> > Buf = MemoryBuffer::getFile(FileName);
+  if (std::error_code EC = Buf.getError())
+    return EC;
+
+  SmallVector<StringRef, 64> Lines;
+  Buf.get()->getBuffer().split(Lines, "\n");
+  for (unsigned i = 0, e = Lines.size(); i != e; ++i) {
+    StringRef Line = Lines[i].trim();
+    if (Line.empty() || Line.startswith("#"))
+      continue;
+    std::pair<StringRef, StringRef> Fields = getToken(Line);
+    BatchEntry Entry;
+    Entry.FileName = Fields.first;
+    Entry.TripleName = Fields.second.trim();
+    Entries.push_back(Entry);
+  }
+  return std::error_code();
+}
+
+///===---------------------------------------------------------------------===//
+/// loadExecutable  - Opens an object file, or wraps raw bytes in a
+/// DummyObjectFile like fracture-cl does.
+///
+static std::unique_ptr<object::ObjectFile> loadExecutable(StringRef FileName,
+  std::string &Msg) {
+  std::unique_ptr<object::ObjectFile> Executable;
+  ErrorOr<object::OwningBinary<object::Binary> > Binary
+    = object::createBinary(FileName);
+  if (Binary.getError()) {
+    ErrorOr<std::unique_ptr<MemoryBuffer> > MemBuf =
+      MemoryBuffer::getFile(FileName);
+    if (std::error_code EC = MemBuf.getError()) {
+      Msg = "could not read file: " + EC.message();
+      return Executable;
+    }
+    Executable.reset(
+      object::DummyObjectFile::createDummyObjectFile(MemBuf.get()));
+    return Executable;
+  }
+  if (!Binary.get().getBinary()->isObject()) {
+    Msg = "not an object file";
+    return Executable;
+  }
+  std::pair<std::unique_ptr<object::Binary>, std::unique_ptr<MemoryBuffer> >
+    Res = Binary.get().takeBinary();
+  ErrorOr<std::unique_ptr<object::ObjectFile> > Obj
+    = object::ObjectFile::createObjectFile(
+      Res.second.release()->getMemBufferRef());
+  if (std::error_code EC = Obj.getError()) {
+    Msg = "could not open object file: " + EC.message();
+    return Executable;
+  }
+  Executable.swap(Obj.get());
+  return Executable;
+}
+
+///===---------------------------------------------------------------------===//
+/// setupEntry      - Loads a binary into the worker's Disassembler and
+/// Decompiler, reusing them if the target did not change.
+///
+static bool setupEntry(const BatchEntry &Entry, std::string &Msg) {
+  std::unique_ptr<object::ObjectFile> Executable =
+    loadExecutable(Entry.FileName, Msg);
+  if (!Executable)
+    return false;
+
+  std::string FeaturesStr;
+  if (MAttrs.size()) {
+    SubtargetFeatures Features;
+    for (unsigned int i = 0; i < MAttrs.size(); ++i)
+      Features.AddFeature(MAttrs[i]);
+    FeaturesStr = Features.getString();
+  }
+
+  Triple TT("unknown-unknown-unknown");
+  StringRef EntryTriple = Entry.TripleName.empty() ? StringRef(TripleName)
+    : StringRef(Entry.TripleName);
+  if (EntryTriple.empty())
+    TT.setArch(Triple::ArchType(Executable->getArch()));
+  else
+    TT.setTriple(Triple::normalize(EntryTriple));
+
+  if (Directors == NULL)
+    Directors = new MCDirectorRegistry(nulls(), nulls());
+  MCDirector *NewMCD = Directors->getDirector(TT.str(), "generic",
+    FeaturesStr, TargetOptions(), Reloc::DynamicNoPIC, CodeModel::Default,
+    CodeGenOpt::Default);
+  if (!NewMCD->isValid()) {
+    Msg = "unsupported target: " + TT.str();
+    return false;
+  }
+  if (DEC != NULL && NewMCD == MCD) {
+    DAS->setExecutable(Executable.release());
+    DEC->reset();
+  } else {
+    // NOTE: The Decompiler deletes its Disassembler.
+    delete DEC;
+    MCD = NewMCD;
+    DAS = new Disassembler(MCD, Executable.release(), NULL, nulls(),
+      DisasErrorsOut);
+    DEC = new Decompiler(DAS, NULL, nulls(), nulls());
+    if (CoverageMode)
+      DEC->setCoverageProfile(&Coverage);
+    if (!Optimizer.empty())
+      DEC->setOptPipeline(&Optimizer);
+    DEC->setRegisterSSA(RegSSA);
+  }
+  DAS->setMemoryBudget(uint64_t(MemoryBudget) << 20);
+  DisasErrorsOut.flush();
+  DisasErrors.clear();
+  return true;
+}
+
+///===---------------------------------------------------------------------===//
+/// runEntry        - Decompiles every function found in one binary.
+///
+static bool runEntry(const BatchEntry &Entry, std::string &Msg) {
+  if (!setupEntry(Entry, Msg))
+    return false;
+
+  OutputFormat Format = EmitBitcode ? Bitcode : TextIR;
+  SmallString<128> OutName(OutputDir);
+  sys::path::append(OutName, sys::path::filename(Entry.FileName));
+
+  std::unique_ptr<FunctionStreamer> Streamer;
+  if (StreamFunctions) {
+    if (std::error_code EC = sys::fs::create_directories(Twine(OutName))) {
+      Msg = "could not create " + OutName.str().str() + ": " + EC.message();
+      return false;
+    }
+    Streamer.reset(new FunctionStreamer(OutName, Format));
+    DEC->setFunctionStreamer(Streamer.get());
+  }
+
+  FunctionDiscovery Discovery(DAS);
+  Discovery.addSeed(DAS->getCurrentSection().getAddress());
+  Discovery.addSymbolSeeds(DAS->getExecutable());
+  Discovery.run();
+  const FunctionDiscovery::ExtentMap &Functions = Discovery.getFunctions();
+  for (FunctionDiscovery::ExtentMap::const_iterator I = Functions.begin(),
+         E = Functions.end(); I != E; ++I)
+    DEC->decompile(I->first);
+
+  std::error_code EC;
+  if (Streamer) {
+    DEC->setFunctionStreamer(NULL);
+    EC = Streamer->finish(*DEC->getModule());
+  } else if (!OutputDir.empty()) {
+    OutName += Format == Bitcode ? ".bc" : ".ll";
+    EC = writeModule(*DEC->getModule(), OutName, Format);
+  }
+  if (EC) {
+    Msg = "could not write " + OutName.str().str() + ": " + EC.message();
+    return false;
+  }
+
+  Msg = utostr(Functions.size()) + " functions";
+  return true;
+}
+
+///===---------------------------------------------------------------------===//
+/// runInstTest     - Decompiles a single instruction binary at 0x0.
+///
+static bool runInstTest(const BatchEntry &Entry, std::string &Msg) {
+  if (!setupEntry(Entry, Msg))
+    return false;
+
+  // Decode failures take precedence over anything the decompiler does with
+  // the result, as in allInstTest.sh.
+  DAS->disassemble(0);
+  DisasErrorsOut.flush();
+  if (DisasErrors.find("instruction decode failed") != std::string::npos) {
+    Msg = "instruction decode failed";
+    return false;
+  }
+  DEC->decompile(0);
+  return true;
+}
+
+///===---------------------------------------------------------------------===//
+/// writeInstTestResults - Appends one allInstTest.sh result line per binary.
+///
+static void writeInstTestResults(raw_ostream &Out,
+  const std::vector<BatchEntry> &Entries,
+  const std::vector<BatchRunner::Result> &Results) {
+  std::string Label = InstTestLabel;
+  if (Label.empty())
+    Label = Triple(TripleName).getArchName();
+
+  for (unsigned i = 0, e = Results.size(); i != e; ++i) {
+    StringRef Name = sys::path::filename(Entries[i].FileName);
+    const BatchRunner::Result &R = Results[i];
+    Out << Label << " BIN,DEC 0x0,";
+    switch (R.JobStatus) {
+      case BatchRunner::Success:
+        Out << "SUCCESS," << Name << "\n";
+        break;
+      case BatchRunner::Failed:
+        if (R.Message == "instruction decode failed")
+          Out << "Disas Unknown Instruction, " << Name << "\n";
+        else
+          Out << "SEG FAULT or ABORT, " << Name << "\n";
+        break;
+      case BatchRunner::FatalError: {
+        // The failing opcode follows an "=" token, e.g. "... node = ADDri".
+        SmallVector<StringRef, 16> Tokens;
+        SplitString(R.Message, Tokens);
+        bool Found = false;
+        for (unsigned t = 0; t + 1 < Tokens.size(); ++t)
+          if (Tokens[t] == "=") {
+            Out << "llvm Error, " << Name << "," << Tokens[t + 1] << "\n";
+            Found = true;
+          }
+        if (!Found)
+          Out << "llvm Error, " << Name << ",\n";
+        break;
+      }
+      case BatchRunner::Crashed:
+      case BatchRunner::TimedOut:
+        Out << "SEG FAULT or ABORT, " << Name << "\n";
+        break;
+    }
+  }
+}
+
+/// Job data is the -stats JSON object (or nothing) on the first line, then
+/// the -coverage profile of the binary as written by CoverageProfile::print.
+///
+static void writeJobData(std::string &Data) {
+  raw_string_ostream DataOut(Data);
+  if (CollectStats)
+    Metrics::get().writeJSON(DataOut);
+  DataOut << "\n";
+  if (CoverageMode)
+    Coverage.print(DataOut);
+}
+
+static std::pair<StringRef, StringRef> splitJobData(StringRef Data) {
+  return Data.split('\n');
+}
+
+///===---------------------------------------------------------------------===//
+/// writeSummary    - Writes the totals and the result of every binary.
+///
+static void writeSummary(raw_ostream &Out,
+  const std::vector<BatchEntry> &Entries,
+  const std::vector<BatchRunner::Result> &Results, double Seconds) {
+  unsigned Counts[BatchRunner::TimedOut + 1] = { 0 };
+  CoverageProfile Total;
+  for (unsigned i = 0, e = Results.size(); i != e; ++i) {
+    ++Counts[Results[i].JobStatus];
+    Total.read(splitJobData(Results[i].Data).second);
+  }
+
+  Out << "{\n  \"binaries\": " << Entries.size() << ",\n";
+  for (unsigned S = BatchRunner::Success; S <= BatchRunner::TimedOut; ++S)
+    Out << "  \"" << BatchRunner::getStatusName((BatchRunner::Status)S)
+        << "\": " << Counts[S] << ",\n";
+  Out << "  \"seconds\": " << format("%.3f", Seconds) << ",\n";
+  Out << "  \"results\": [\n";
+  for (unsigned i = 0, e = Results.size(); i != e; ++i) {
+    Out << "    { \"file\": ";
+    writeJSONString(Out, Entries[i].FileName);
+    Out << ", \"triple\": ";
+    writeJSONString(Out, Entries[i].TripleName.empty() ? TripleName
+      : Entries[i].TripleName);
+    Out << ", \"status\": \""
+        << BatchRunner::getStatusName(Results[i].JobStatus) << "\""
+        << ", \"seconds\": " << format("%.3f", Results[i].Seconds)
+        << ", \"message\": ";
+    writeJSONString(Out, Results[i].Message);
+    std::pair<StringRef, StringRef> Data = splitJobData(Results[i].Data);
+    if (!Data.first.empty())
+      Out << ", \"stats\": " << Data.first;
+    if (CoverageMode) {
+      CoverageProfile Binary;
+      Binary.read(Data.second);
+      Out << ", \"unhandled\": " << Binary.getTotal();
+    }
+    Out << " }" << (i + 1 != e ? "," : "") << "\n";
+  }
+  Out << "  ]";
+  if (CoverageMode) {
+    Out << ",\n  \"coverage\": ";
+    Total.writeJSON(Out);
+  }
+  Out << "\n}\n";
+}
+
+int main(int argc, char *argv[]) {
+  ProgramName = sys::path::filename(argv[0]);
+
+  // Stack trace err hdlr
+  sys::PrintStackTraceOnErrorSignal();
+  PrettyStackTraceProgram X(argc, argv);
+
+  // Calls a shutdown function when destructor is called
+  llvm_shutdown_obj Y;
+
+  // Initialized once, before the workers are forked.
+  InitializeAllTargetInfos();
+  InitializeAllTargetMCs();
+  InitializeAllAsmParsers();
+  InitializeAllDisassemblers();
+  InitializeAllTargets();
+
+  cl::ParseCommandLineOptions(argc, argv, "fracture batch decompiler");
+
+  std::vector<BatchEntry> Entries;
+  for (unsigned i = 0, e = Inputs.size(); i != e; ++i) {
+    if (InstTest) {
+      BatchEntry Entry;
+      Entry.FileName = Inputs[i];
+      Entries.push_back(Entry);
+    } else if (std::error_code EC = readManifest(Inputs[i], Entries)) {
+      errs() << ProgramName << ": Could not read manifest '" << Inputs[i]
+             << "'. " << EC.message() << ".\n";
+      return 1;
+    }
+  }
+  if (Optimize || !OptPasses.empty()) {
+    std::string Error;
+    if (!Optimizer.parse(OptPasses.empty() ? OptPipeline::DefaultPasses
+        : OptPasses, Error)) {
+      errs() << ProgramName << ": " << Error << ".\n";
+      return 1;
+    }
+  }
+  if (StreamFunctions && OutputDir.empty()) {
+    errs() << ProgramName << ": -stream needs an output directory (-o).\n";
+    return 1;
+  }
+  if (!OutputDir.empty())
+    sys::fs::create_directories(Twine(OutputDir));
+
+  std::vector<BatchRunner::Result> Results;
+  BatchRunner Runner(NumJobs, Timeout, errs());
+  // Keeps the unhandled opcode counts of binaries that end in a fatal error.
+  Runner.setFatalData(writeJobData);
+  TimeRecord Start = TimeRecord::getCurrentTime();
+  Runner.run(Entries.size(),
+    [&Entries](unsigned Index, std::string &Msg, std::string &Data) {
+      // Workers run many binaries, count each one on its own.
+      Metrics::get().reset();
+      Coverage.clear();
+      bool OK = InstTest ? runInstTest(Entries[Index], Msg)
+        : runEntry(Entries[Index], Msg);
+      writeJobData(Data);
+      return OK;
+    }, Results);
+  double Seconds = TimeRecord::getCurrentTime().getWallTime()
+    - Start.getWallTime();
+
+  std::error_code EC;
+  // The -inst-test CSV is appended after allInstTest.sh's header lines.
+  raw_fd_ostream Summary(SummaryName, EC,
+    InstTest ? sys::fs::F_Append | sys::fs::F_Text : sys::fs::F_Text);
+  if (EC) {
+    errs() << ProgramName << ": Could not write summary '" << SummaryName
+           << "'. " << EC.message() << ".\n";
+    return 1;
+  }
+  if (InstTest)
+    writeInstTestResults(Summary, Entries, Results);
+  else
+    writeSummary(Summary, Entries, Results, Seconds);
+
+  delete DEC;
+  delete Directors;
+  return 0;
+}
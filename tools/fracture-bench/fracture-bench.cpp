@@ -0,0 +1,352 @@
+//===--- fracture-bench.cpp - Pipeline Benchmarks ---------------*- C++ -*-===//
+//
+//              Fracture: The Draper Decompiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Times each stage of the decompiler separately over a set of binaries:
+//
+//   load      - opening the object file
+//   symbols   - indexing the symbol table by address
+//   discover  - finding the functions (FunctionDiscovery)
+//   decode    - disassembling every function (decodeInstruction)
+//   dag       - createDAGFromMachineBasicBlock on every block
+//   invert    - the inverse instruction selector (Transmogrify) on each DAG
+//   emit      - IR emission (EmitIR) from each inverted DAG
+//   decompile - decompiling the whole module from a fresh executable
+//
+// Each binary is run -iterations times, and the minimum and median seconds
+// of every stage are written as JSON, with the number of items (bytes,
+// symbols, functions, instructions, DAG nodes, IR instructions) the stage
+// handled. Keys and formatting are fixed so results diff cleanly across
+// commits; "make bench" in test/ runs it over samples/.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ADT/Triple.h"
+#include "llvm/CodeGen/SelectionDAG.h"
+#include "llvm/IR/Module.h"
+#include "llvm/MC/SubtargetFeature.h"
+#include "llvm/Object/Binary.h"
+#include "llvm/Object/ObjectFile.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/ManagedStatic.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/PrettyStackTrace.h"
+#include "llvm/Support/Signals.h"
+#include "llvm/Support/TargetRegistry.h"
+#include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/Timer.h"
+#include "llvm/Target/TargetOptions.h"
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "CodeInv/Decompiler.h"
+#include "CodeInv/Disassembler.h"
+#include "CodeInv/FunctionDiscovery.h"
+#include "CodeInv/JSONWriter.h"
+#include "CodeInv/MCDirectorRegistry.h"
+
+using namespace llvm;
+using namespace fracture;
+
+//===----------------------------------------------------------------------===//
+// Global Variables and Parameters
+//===----------------------------------------------------------------------===//
+static std::string ProgramName;
+
+enum Stage { Load, Symbols, Discover, Decode, DAGBuild, Invert, Emit,
+             Decompile, NumStages };
+
+static const char *StageNames[NumStages] = { "load", "symbols", "discover",
+  "decode", "dag", "invert", "emit", "decompile" };
+
+/// Results of one binary: the seconds of every iteration, and the items of
+/// the last one, per stage.
+struct BenchResult {
+  std::string FileName;
+  std::string TripleName;
+  std::string Error;
+  std::vector<double> Seconds[NumStages];
+  uint64_t Items[NumStages];
+};
+
+//Command Line Options
+static cl::list<std::string> Inputs(cl::Positional, cl::OneOrMore,
+    cl::desc("<binary>..."));
+
+static cl::opt<std::string> TripleName("triple",
+    cl::desc("Target triple (default: from each binary)"));
+
+static cl::list<std::string> MAttrs("mattr", cl::CommaSeparated,
+    cl::desc("Target specific attributes"), cl::value_desc("a1,+a2,-a3,..."));
+
+static cl::opt<unsigned> Iterations("iterations",
+    cl::desc("Number of times to run each binary (default: 5)"),
+    cl::init(5));
+
+static cl::opt<std::string> OutputName("o",
+    cl::desc("File to write the JSON results to (default: stdout)"),
+    cl::value_desc("filename"), cl::init("-"));
+
+static double getWallTime() {
+  return TimeRecord::getCurrentTime().getWallTime();
+}
+
+///===---------------------------------------------------------------------===//
+/// loadExecutable  - Opens an object file.
+///
+static object::ObjectFile* loadExecutable(StringRef FileName,
+  std::string &Msg) {
+  ErrorOr<object::OwningBinary<object::Binary> > Binary
+    = object::createBinary(FileName);
+  if (std::error_code EC = Binary.getError()) {
+    Msg = "could not open: " + EC.message();
+    return NULL;
+  }
+  if (!Binary.get().getBinary()->isObject()) {
+    Msg = "not an object file";
+    return NULL;
+  }
+  std::pair<std::unique_ptr<object::Binary>, std::unique_ptr<MemoryBuffer> >
+    Res = Binary.get().takeBinary();
+  ErrorOr<std::unique_ptr<object::ObjectFile> > Obj
+    = object::ObjectFile::createObjectFile(
+      Res.second.release()->getMemBufferRef());
+  if (std::error_code EC = Obj.getError()) {
+    Msg = "could not open object file: " + EC.message();
+    return NULL;
+  }
+  return Obj.get().release();
+}
+
+///===---------------------------------------------------------------------===//
+/// runIteration    - Runs every stage once on a binary. The Disassembler and
+/// Decompiler are made on the first iteration and pointed at a freshly loaded
+/// executable on the others, so nothing decoded before is reused.
+///
+static bool runIteration(MCDirectorRegistry &Directors, BenchResult &R,
+  Disassembler *&DAS, Decompiler *&DEC) {
+  double Start = getWallTime();
+  object::ObjectFile *Executable = loadExecutable(R.FileName, R.Error);
+  if (Executable == NULL)
+    return false;
+  R.Seconds[Load].push_back(getWallTime() - Start);
+  R.Items[Load] = Executable->getData().size();
+
+  if (DEC == NULL) {
+    Triple TT("unknown-unknown-unknown");
+    if (TripleName.empty())
+      TT.setArch(Triple::ArchType(Executable->getArch()));
+    else
+      TT.setTriple(Triple::normalize(TripleName));
+    R.TripleName = TT.str();
+
+    std::string FeaturesStr;
+    if (MAttrs.size()) {
+      SubtargetFeatures Features;
+      for (unsigned int i = 0; i < MAttrs.size(); ++i)
+        Features.AddFeature(MAttrs[i]);
+      FeaturesStr = Features.getString();
+    }
+    MCDirector *MCD = Directors.getDirector(TT.str(), "generic", FeaturesStr,
+      TargetOptions(), Reloc::DynamicNoPIC, CodeModel::Default,
+      CodeGenOpt::Default);
+    if (!MCD->isValid()) {
+      R.Error = "unsupported target: " + TT.str();
+      delete Executable;
+      return false;
+    }
+    DAS = new Disassembler(MCD, Executable, NULL, nulls(), nulls());
+    DEC = new Decompiler(DAS, NULL, nulls(), nulls());
+  } else {
+    DAS->setExecutable(Executable);
+    DEC->reset();
+  }
+
+  Start = getWallTime();
+  std::map<uint64_t, StringRef> SymbolIndex;
+  for (object::symbol_iterator I = Executable->symbols().begin(),
+         E = Executable->symbols().end(); I != E; ++I) {
+    uint64_t SymAddr;
+    StringRef SymName;
+    if (I->getAddress(SymAddr) || SymAddr == object::UnknownAddressOrSize
+      || I->getName(SymName))
+      continue;
+    SymbolIndex[SymAddr] = SymName;
+  }
+  R.Seconds[Symbols].push_back(getWallTime() - Start);
+  R.Items[Symbols] = SymbolIndex.size();
+
+  Start = getWallTime();
+  std::vector<unsigned> Addresses;
+  {
+    FunctionDiscovery Discovery(DAS);
+    Discovery.addSeed(DAS->getCurrentSection().getAddress());
+    Discovery.addSymbolSeeds(Executable);
+    Discovery.run();
+    const FunctionDiscovery::ExtentMap &Functions = Discovery.getFunctions();
+    for (FunctionDiscovery::ExtentMap::const_iterator I = Functions.begin(),
+           E = Functions.end(); I != E; ++I)
+      Addresses.push_back(I->first);
+  }
+  R.Seconds[Discover].push_back(getWallTime() - Start);
+  R.Items[Discover] = Addresses.size();
+
+  Start = getWallTime();
+  std::vector<MachineFunction*> MFs;
+  uint64_t NumInsts = 0;
+  for (unsigned i = 0, e = Addresses.size(); i != e; ++i) {
+    MachineFunction *MF = DAS->disassemble(Addresses[i]);
+    if (MF == NULL)
+      continue;
+    MFs.push_back(MF);
+    for (MachineFunction::iterator BI = MF->begin(), BE = MF->end();
+         BI != BE; ++BI)
+      NumInsts += BI->size();
+  }
+  R.Seconds[Decode].push_back(getWallTime() - Start);
+  R.Items[Decode] = NumInsts;
+
+  // The three DAG stages run block by block, so they are timed per block and
+  // summed.
+  double StageSeconds[NumStages] = { 0 };
+  uint64_t StageItems[NumStages] = { 0 };
+  Module *Mod = DEC->getModule();
+  FunctionType *FType = FunctionType::get(Type::getVoidTy(Mod->getContext()),
+    false);
+  for (unsigned i = 0, e = MFs.size(); i != e; ++i) {
+    Function *F = cast<Function>(Mod->getOrInsertFunction(MFs[i]->getName(),
+        FType));
+    for (MachineFunction::iterator BI = MFs[i]->begin(), BE = MFs[i]->end();
+         BI != BE; ++BI) {
+      Start = getWallTime();
+      SelectionDAG *DAG = DEC->createDAGFromMachineBasicBlock(BI);
+      StageSeconds[DAGBuild] += getWallTime() - Start;
+      StageItems[DAGBuild] += DAG->allnodes_size();
+
+      Start = getWallTime();
+      DEC->invertDAG(DAG);
+      StageSeconds[Invert] += getWallTime() - Start;
+      StageItems[Invert] += DAG->allnodes_size();
+
+      Start = getWallTime();
+      BasicBlock *BB = DEC->emitDAG(DAG, BI->getName(), F);
+      StageSeconds[Emit] += getWallTime() - Start;
+      StageItems[Emit] += BB->size();
+      // NOTE: Freed the same way decompileBasicBlock does.
+      free(DAG);
+    }
+  }
+  for (unsigned S = DAGBuild; S <= Emit; ++S) {
+    R.Seconds[S].push_back(StageSeconds[S]);
+    R.Items[S] = StageItems[S];
+  }
+
+  // Whole module, from a fresh executable so decoding is included.
+  Executable = loadExecutable(R.FileName, R.Error);
+  if (Executable == NULL)
+    return false;
+  DAS->setExecutable(Executable);
+  DEC->reset();
+  Start = getWallTime();
+  for (unsigned i = 0, e = Addresses.size(); i != e; ++i)
+    DEC->decompile(Addresses[i]);
+  R.Seconds[Decompile].push_back(getWallTime() - Start);
+  uint64_t NumIRInsts = 0;
+  for (Module::iterator FI = DEC->getModule()->begin(),
+         FE = DEC->getModule()->end(); FI != FE; ++FI)
+    for (Function::iterator BI = FI->begin(), BE = FI->end(); BI != BE; ++BI)
+      NumIRInsts += BI->size();
+  R.Items[Decompile] = NumIRInsts;
+  return true;
+}
+
+///===---------------------------------------------------------------------===//
+/// writeResults    - Writes the stage times of every binary.
+///
+static void writeResults(raw_ostream &Out,
+  const std::vector<BenchResult> &Results) {
+  Out << "{\n  \"iterations\": " << Iterations << ",\n";
+  Out << "  \"binaries\": [\n";
+  for (unsigned i = 0, e = Results.size(); i != e; ++i) {
+    const BenchResult &R = Results[i];
+    Out << "    {\n      \"file\": ";
+    writeJSONString(Out, R.FileName);
+    Out << ",\n      \"triple\": ";
+    writeJSONString(Out, R.TripleName);
+    if (!R.Error.empty()) {
+      Out << ",\n      \"error\": ";
+      writeJSONString(Out, R.Error);
+    }
+    Out << ",\n      \"stages\": {\n";
+    for (unsigned S = 0; S != NumStages; ++S) {
+      std::vector<double> Seconds = R.Seconds[S];
+      std::sort(Seconds.begin(), Seconds.end());
+      double Min = Seconds.empty() ? 0 : Seconds.front();
+      double Median = Seconds.empty() ? 0 : Seconds[Seconds.size() / 2];
+      Out << "        \"" << StageNames[S] << "\": { \"items\": "
+          << (Seconds.empty() ? 0 : R.Items[S])
+          << ", \"min\": " << format("%.6f", Min)
+          << ", \"median\": " << format("%.6f", Median) << " }"
+          << (S + 1 != NumStages ? "," : "") << "\n";
+    }
+    Out << "      }\n    }" << (i + 1 != e ? "," : "") << "\n";
+  }
+  Out << "  ]\n}\n";
+}
+
+int main(int argc, char *argv[]) {
+  ProgramName = sys::path::filename(argv[0]);
+
+  // Stack trace err hdlr
+  sys::PrintStackTraceOnErrorSignal();
+  PrettyStackTraceProgram X(argc, argv);
+
+  // Calls a shutdown function when destructor is called
+  llvm_shutdown_obj Y;
+
+  InitializeAllTargetInfos();
+  InitializeAllTargetMCs();
+  InitializeAllAsmParsers();
+  InitializeAllDisassemblers();
+  InitializeAllTargets();
+
+  cl::ParseCommandLineOptions(argc, argv, "fracture pipeline benchmarks");
+
+  MCDirectorRegistry Directors(nulls(), nulls());
+  std::vector<BenchResult> Results(Inputs.size());
+  for (unsigned i = 0, e = Inputs.size(); i != e; ++i) {
+    BenchResult &R = Results[i];
+    R.FileName = Inputs[i];
+    std::fill(R.Items, R.Items + NumStages, 0);
+    // NOTE: The Decompiler deletes its Disassembler.
+    Disassembler *DAS = NULL;
+    Decompiler *DEC = NULL;
+    for (unsigned It = 0; It != Iterations; ++It)
+      if (!runIteration(Directors, R, DAS, DEC))
+        break;
+    if (!R.Error.empty())
+      errs() << ProgramName << ": " << R.FileName << ": " << R.Error << "\n";
+    delete DEC;
+  }
+
+  std::error_code EC;
+  raw_fd_ostream Out(OutputName, EC, sys::fs::F_Text);
+  if (EC) {
+    errs() << ProgramName << ": Could not write '" << OutputName << "'. "
+           << EC.message() << ".\n";
+    return 1;
+  }
+  writeResults(Out, Results);
+  return 0;
+}
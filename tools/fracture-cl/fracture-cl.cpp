@@ -27,6 +27,7 @@
 #include "llvm/IR/DerivedTypes.h"
 #include "llvm/IR/Type.h"
 #include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Verifier.h"
 #include "llvm/Object/Binary.h"
 #include "llvm/Object/COFF.h"
 #include "llvm/Object/ELFObjectFile.h"
@@ -47,6 +48,7 @@
 
 #include <string>
 #include <algorithm>
+#include <functional>
 #include <map>
 #include <inttypes.h>
 #include <signal.h>
@@ -65,8 +67,14 @@
 #include <fstream>
 #include "BinFun.h"
 #include "DummyObjectFile.h"
+#include "CodeInv/CoverageProfile.h"
 #include "CodeInv/Decompiler.h"
+#include "CodeInv/DecompilerListener.h"
 #include "CodeInv/Disassembler.h"
+#include "CodeInv/MCDirectorRegistry.h"
+#include "CodeInv/ModuleWriter.h"
+#include "CodeInv/OptPipeline.h"
+#include "CodeInv/Metrics.h"
 #include "CodeInv/StrippedDisassembler.h"
 //#include "CodeInv/InvISelDAG.h"
 //#include "CodeInv/MCDirector.h"
@@ -89,9 +97,14 @@ using namespace fracture;
 static std::string ProgramName;
 static Commands CommandParser;
 
+// NOTE: Like the objects below, the registry lives until exit.
+static MCDirectorRegistry *Directors = 0;
 MCDirector *MCD = 0;
 Disassembler *DAS = 0;
 Decompiler *DEC = 0;
+CoverageProfile Coverage;
+FunctionStreamer *Streamer = NULL;
+OptPipeline Optimizer;
 StrippedDisassembler *SDAS = 0;
 std::unique_ptr<object::ObjectFile> TempExecutable;
 bool isStripped = false;
@@ -121,6 +134,49 @@ static cl::opt<bool> StrippedBinary("stripped", cl::Hidden,
 static cl::opt<bool> printGraph("print-graph", cl::Hidden,
     cl::desc("Print graph for stripped file, must also enable stripped command"));
 
+static cl::opt<bool> LazyDecompile("lazy",
+    cl::desc("Decompile only the requested function, leaving callees as "
+      "declarations for the materialize command."));
+
+static cl::opt<bool> RegSSA("reg-ssa",
+    cl::desc("Emit registers as SSA values instead of loads and stores of "
+      "globals"));
+
+static cl::opt<bool> Optimize("opt",
+    cl::desc("Optimize every decompiled function with mem2reg, instcombine, "
+      "simplifycfg and dce"));
+
+static cl::opt<std::string> OptPasses("opt-passes",
+    cl::desc("Comma separated passes to optimize every decompiled function "
+      "with, instead of the -opt ones"), cl::value_desc("passes"));
+
+static cl::opt<unsigned> MemoryBudget("memory-budget",
+    cl::desc("Free the machine code of decompiled functions once it takes "
+      "more than this many MB, 0 for no limit"), cl::init(0));
+
+static cl::opt<bool> CoverageMode("coverage",
+    cl::desc("Record nodes the decompiler cannot lower instead of aborting "
+      "(see the coverage command)."));
+
+static cl::opt<bool> VerifyIR("verify-ir",
+    cl::desc("Verify every decompiled function as soon as it is done, before "
+      "it is streamed out"));
+
+///===---------------------------------------------------------------------===//
+/// FunctionVerifier - Reports decompiled functions that are not valid IR.
+/// Streamed bodies are gone by the time the module could be verified, so
+/// this runs as the Decompiler's listener.
+///
+class FunctionVerifier : public DecompilerListener {
+public:
+  virtual void functionDecompiled(Function *F) {
+    if (verifyFunction(*F, &errs()))
+      errs() << ProgramName << ": '" << F->getName()
+             << "' is not valid IR.\n";
+  }
+};
+static FunctionVerifier IRVerifier;
+
 
 static bool error(std::error_code ec) {
   if (!ec)
@@ -130,6 +186,23 @@ static bool error(std::error_code ec) {
   return true;
 }
 
+///===---------------------------------------------------------------------===//
+/// endStreaming    - Writes the globals file of "save -stream", if it is on,
+/// and turns it off.
+///
+static void endStreaming() {
+  if (Streamer == NULL)
+    return;
+  DEC->setFunctionStreamer(NULL);
+  if (std::error_code EC = Streamer->finish(*DEC->getModule()))
+    errs() << ProgramName << ": Could not write the globals to '"
+           << Streamer->getDirectory() << "'. " << EC.message() << ".\n";
+  outs() << "Streamed " << Streamer->getNumWritten() << " functions to '"
+         << Streamer->getDirectory() << "'.\n";
+  delete Streamer;
+  Streamer = NULL;
+}
+
 ///===---------------------------------------------------------------------===//
 /// loadBinary      - Tries to open the file and set the ObjectFile.
 /// NOTE: Binary is a subclass of ObjectFile, but Binary multiply inherits
@@ -193,17 +266,37 @@ static std::error_code loadBinary(StringRef FileName) {
   if (!ArchName.empty())
     TT.setArchName(ArchName);
 
-  TripleName = TT.str();
-
-  delete DEC;
-  delete DAS;
-  delete MCD;
+  // NOTE: TripleName is left alone so the next load detects its own arch.
+  std::string TheTriple = TT.str();
 
-  MCD = new MCDirector(TripleName, "generic", FeaturesStr,
-    TargetOptions(), Reloc::DynamicNoPIC, CodeModel::Default, CodeGenOpt::Default,
-    outs(), errs());
-  DAS = new Disassembler(MCD, TempExecutable.release(), NULL, outs(), outs());
-  DEC = new Decompiler(DAS, NULL, outs(), outs());
+  // Directors are cached per target, so reloading a binary of the same
+  // architecture keeps the target machine and just swaps the executable.
+  if (Directors == NULL) {
+    Directors = new MCDirectorRegistry(outs(), errs());
+  }
+  MCDirector *NewMCD = Directors->getDirector(TheTriple, "generic",
+    FeaturesStr, TargetOptions(), Reloc::DynamicNoPIC, CodeModel::Default,
+    CodeGenOpt::Default);
+  // The streamed files belong to the old module.
+  endStreaming();
+  if (DEC != NULL && NewMCD == MCD) {
+    DAS->setExecutable(TempExecutable.release());
+    DEC->reset();
+  } else {
+    // NOTE: The Decompiler deletes its Disassembler.
+    delete DEC;
+    MCD = NewMCD;
+    DAS = new Disassembler(MCD, TempExecutable.release(), NULL, outs(), outs());
+    DEC = new Decompiler(DAS, NULL, outs(), outs());
+    if (CoverageMode)
+      DEC->setCoverageProfile(&Coverage);
+    if (!Optimizer.empty())
+      DEC->setOptPipeline(&Optimizer);
+    if (VerifyIR)
+      DEC->setListener(&IRVerifier);
+    DEC->setRegisterSSA(RegSSA);
+  }
+  DAS->setMemoryBudget(uint64_t(MemoryBudget) << 20);
 
   if (!MCD->isValid()) {
     errs() << "Warning: Unable to initialized LLVM MC API!\n";
@@ -267,24 +360,65 @@ static void printHelp(std::vector<std::string> &CommandLine) {
                << "\tLoad a given binary into Fracture while Fracture is "
                << "already running\n\n\n";
         break;
+      case  str2int("materialize") :
+        outs() << "materialize - Decompile callees left by decompile -lazy\n"
+               << "USAGE:\n"
+               << "\tmaterialize or materialize [FUNCNAME]\n"
+               << "DESCRIPTION:\n"
+               << "\tDecompile the body of the callee declaration FUNCNAME, "
+               << "leaving its own\n\tcallees as declarations. Without "
+               << "FUNCNAME, decompile every callee\n\treachable from "
+               << "what was decompiled so far. Library calls stay\n\t"
+               << "declarations.\n\n\n";
+        break;
       case  str2int("quit") :
         outs() << "quit - Terminate the application\n\n\n";
         break;
       case  str2int("save") :
         outs() << "save - Save LLVM IR to a file\n"
                << "USAGE:\n"
-               << "\tsave [FILENAME]\n"
+               << "\tsave [FILENAME], save -stream DIRECTORY [ll] or "
+               << "save -stream-end\n"
                << "DESCRIPTION:\n"
                << "\tSave decompiled LLVM IR to a file using the specified file"
                << "name.\n\tThe decompile command must be run before running "
-               << "the save command.\n\tDecompiled LLVM IR should be saved as a"
-               << " .ll file, which can then be\n\trun using the lli command"
-               << " outside of fracture.\n\n\n";
+               << "the save command.\n\tFILENAME ending in .bc is written as "
+               << "bitcode, anything else as a .ll\n\ttext file. Either can "
+               << "be run using the lli command outside of fracture.\n"
+               << "\tWith -stream, every function decompiled from then on is "
+               << "written to its\n\town bitcode (or ll) file in DIRECTORY "
+               << "as soon as it is done, and\n\tdropped from memory. "
+               << "-stream-end, load and quit write the shared\n\tglobals "
+               << "to DIRECTORY/globals.bc; llvm-link the directory to get "
+               << "the\n\twhole module.\n\n\n";
                break;
       case  str2int("sections") :
         outs() << "sections - Print the names of all sections contained"
                << " in the binary\n\n\n";
         break;
+      case  str2int("coverage") :
+        outs() << "coverage - Print the nodes the decompiler could not lower\n"
+               << "USAGE:\n"
+               << "\tcoverage, coverage json [FILENAME] or coverage reset\n"
+               << "DESCRIPTION:\n"
+               << "\tWhen started with -coverage, unhandled nodes are "
+               << "recorded and lifted as\n\tcalls to fracture.unhandled.* "
+               << "instead of aborting. Print them by\n\ttarget, "
+               << "instruction and node, most frequent first, with a few "
+               << "of\n\tthe addresses they were seen at. With json, write "
+               << "them as JSON to\n\tstdout or FILENAME.\n\n\n";
+        break;
+      case  str2int("stats") :
+        outs() << "stats - Print decompiler timers and counters\n"
+               << "USAGE:\n"
+               << "\tstats, stats json [FILENAME] or stats reset\n"
+               << "DESCRIPTION:\n"
+               << "\tPrint the time spent decoding, building DAGs, inverting "
+               << "and emitting IR,\n\tthe instruction and DAG node counts, "
+               << "and the opcodes each target could\n\tnot handle, since "
+               << "start up or the last reset. With json, write\n\tthem as "
+               << "JSON to stdout or FILENAME.\n\n\n";
+        break;
       case  str2int("symbols") :
         outs() << "symbols - Print section symbols\n"
                << "USAGE:\n"
@@ -336,11 +470,12 @@ static bool lookupELFName(const object::ELFObjectFile<ELFT>* elf,
     Syms.push_back(temp);
   }
   if (isStripped)
-      for (auto &it : SDAS->getStrippedGraph()->getHeadNodes()) {
-        StringRef name = (SDAS->getMain() == it->Address ?
-                                  "main" : DAS->getFunctionName(it->Address));
-        FractureSymbol tempSym(it->Address, name,
-                               0, object::SymbolRef::Type::ST_Function, 0);
+      for (auto &it : SDAS->getFunctionExtents()) {
+        StringRef name = (SDAS->getMain() == it.first ?
+                                  "main" : DAS->getFunctionName(it.first));
+        FractureSymbol tempSym(it.first, name, 0,
+                               object::SymbolRef::Type::ST_Function,
+                               it.second - it.first);
         Syms.push_back(new FractureSymbol(tempSym));
       }
 
@@ -448,10 +583,54 @@ static void runDecompileCommand(std::vector<std::string> &CommandLine) {
   DEC->setViewIRDAGs(ViewIRDAGs);
 
   formatted_raw_ostream Out(outs(), false);
-  DEC->decompile(Address);
+  if (LazyDecompile) {
+    DEC->decompileLazy(Address);
+  } else {
+    DEC->decompile(Address);
+  }
+  // Streamed bodies are gone, the files hold them.
+  if (Streamer != NULL) {
+    outs() << Streamer->getNumWritten() << " functions streamed to '"
+           << Streamer->getDirectory() << "'.\n";
+    return;
+  }
   DEC->printInstructions(Out, Address);
 }
 
+///===---------------------------------------------------------------------===//
+/// runMaterializeCommand - Decompile callees left as declarations by a lazy
+/// decompile.
+///
+static void runMaterializeCommand(std::vector<std::string> &CommandLine) {
+  if (CommandLine.size() > 2) {
+    errs() << "runMaterializeCommand: invalid command"
+           << "format: materialize [function] \n";
+    return;
+  }
+
+  if (CommandLine.size() == 1) {
+    DEC->materializeAll();
+    return;
+  }
+
+  Function *F = DEC->getModule()->getFunction(CommandLine[1]);
+  if (!DEC->isMaterializable(F)) {
+    errs() << "materialize: '" << CommandLine[1]
+           << "' is not a callee declaration that can be decompiled.\n";
+    return;
+  }
+  DEC->materialize(F);
+  if (F->isDeclaration() && !DEC->isStreamed(F)) {
+    errs() << "materialize: could not decompile '" << CommandLine[1]
+           << "'.\n";
+    return;
+  }
+  if (!DEC->isStreamed(F)) {
+    formatted_raw_ostream Out(outs(), false);
+    Out << *F;
+  }
+}
+
 ///===---------------------------------------------------------------------===//
 /// runDisassembleCommand - Disassemble a given memory address.
 ///
@@ -605,11 +784,12 @@ static void dumpELFSymbols(const object::ELFObjectFile<ELFT>* elf,
     Syms.push_back(temp);
   }
   if (isStripped)
-    for (auto &it : SDAS->getStrippedGraph()->getHeadNodes()) {
-      StringRef name = (SDAS->getMain() == it->Address ?
-                                "main" : DAS->getFunctionName(it->Address));
-      FractureSymbol tempSym(it->Address, name,
-                             0, object::SymbolRef::Type::ST_Function, 0);
+    for (auto &it : SDAS->getFunctionExtents()) {
+      StringRef name = (SDAS->getMain() == it.first ?
+                                "main" : DAS->getFunctionName(it.first));
+      FractureSymbol tempSym(it.first, name, 0,
+                             object::SymbolRef::Type::ST_Function,
+                             it.second - it.first);
       Syms.push_back(new FractureSymbol(tempSym));
     }
 
@@ -918,29 +1098,118 @@ static void runSymbolsCommand(std::vector<std::string> &CommandLine) {
 }
 
 ///===---------------------------------------------------------------------===//
-/// runSaveCommand - Saves current module to a .ll file
+/// runSaveCommand - Saves current module to a .ll or .bc file, or streams
+/// the functions decompiled from now on to a directory
 ///
 static void runSaveCommand(std::vector<std::string> &CommandLine) {
+  if (CommandLine.size() == 2 && CommandLine[1] == "-stream-end") {
+    if (Streamer == NULL)
+      outs() << "save: not streaming.\n";
+    endStreaming();
+    return;
+  }
+
+  if (CommandLine.size() >= 3 && CommandLine[1] == "-stream") {
+    if (CommandLine.size() > 4
+      || (CommandLine.size() == 4 && CommandLine[3] != "ll")) {
+      outs() << "usage: save -stream <directory> [ll]\n";
+      return;
+    }
+    endStreaming();
+    if (std::error_code EC = sys::fs::create_directories(CommandLine[2])) {
+      errs() << ProgramName << ": Could not create '" << CommandLine[2]
+             << "'. " << EC.message() << ".\n";
+      return;
+    }
+    Streamer = new FunctionStreamer(CommandLine[2],
+      CommandLine.size() == 4 ? TextIR : Bitcode);
+    DEC->setFunctionStreamer(Streamer);
+    return;
+  }
+
   if (CommandLine.size() != 2) {
-    outs() << "usage: save <filename.ll>\n";
+    outs() << "usage: save <filename.ll|filename.bc>\n";
     return;
   }
 
-  std::error_code ErrorInfo;
-  raw_fd_ostream FOut(CommandLine[1], ErrorInfo,
-    sys::fs::OpenFlags::F_RW);
+  if (Streamer != NULL)
+    outs() << "save: streamed functions are only declared in '"
+           << CommandLine[1] << "'.\n";
 
-  FOut << *(DEC->getModule());
+  std::error_code ErrorInfo = writeModule(*DEC->getModule(), CommandLine[1],
+    getOutputFormat(CommandLine[1]));
 
   if (ErrorInfo) {
     outs() << "Errors on write: \n" << ErrorInfo.message() << "\n";
   }
 }
 
+///===---------------------------------------------------------------------===//
+/// runReportCommand - Runs "<Name> [json [filename] | reset]" for a report:
+/// prints it, writes it as JSON to the file (stdout by default) or resets it
+///
+static void runReportCommand(std::vector<std::string> &CommandLine,
+  StringRef Name, std::function<void(raw_ostream&)> Print,
+  std::function<void(raw_ostream&)> WriteJSON, std::function<void()> Reset) {
+  if (CommandLine.size() == 1) {
+    Print(outs());
+    return;
+  }
+  if (CommandLine[1] == "reset" && CommandLine.size() == 2) {
+    Reset();
+    return;
+  }
+  if (CommandLine[1] != "json" || CommandLine.size() > 3) {
+    outs() << "usage: " << Name << " [json [filename] | reset]\n";
+    return;
+  }
+
+  std::string FileName = CommandLine.size() == 3 ? CommandLine[2] : "-";
+  outs().flush();
+  std::error_code ErrorInfo;
+  raw_fd_ostream FOut(FileName, ErrorInfo, sys::fs::F_Text);
+  if (ErrorInfo) {
+    errs() << ProgramName << ": Could not write '" << FileName << "'. "
+           << ErrorInfo.message() << ".\n";
+    return;
+  }
+  WriteJSON(FOut);
+  FOut << "\n";
+}
+
+///===---------------------------------------------------------------------===//
+/// runStatsCommand - Prints, exports or resets the decompiler metrics
+///
+static void runStatsCommand(std::vector<std::string> &CommandLine) {
+  runReportCommand(CommandLine, "stats",
+    [](raw_ostream &Out) { Metrics::get().print(Out); },
+    [](raw_ostream &Out) { Metrics::get().writeJSON(Out); },
+    []() { Metrics::get().reset(); });
+}
+
+///===---------------------------------------------------------------------===//
+/// runCoverageCommand - Prints, exports or resets the unhandled node profile
+///
+static void runCoverageCommand(std::vector<std::string> &CommandLine) {
+  if (!CoverageMode) {
+    outs() << "coverage: restart fracture-cl with -coverage to record "
+           << "unhandled nodes.\n";
+    return;
+  }
+  runReportCommand(CommandLine, "coverage",
+    [](raw_ostream &Out) {
+      Coverage.print(Out);
+      Out << Coverage.getTotal() << " unhandled nodes.\n";
+    },
+    [](raw_ostream &Out) { Coverage.writeJSON(Out); },
+    []() { Coverage.clear(); });
+}
+
 ///===---------------------------------------------------------------------===//
 /// runQuitCommand - Exits the program
 ///
 static void runQuitCommand(std::vector<std::string> &CommandLine) {
+  endStreaming();
 	// was 130 but changed to 0 because this exit is after success
 	exit(0);  //Note: This is for fork/exec in shell.
 }
@@ -1028,10 +1297,13 @@ static void initializeCommands() {
   CommandParser.registerCommand("disassemble", &runDisassembleCommand);
   CommandParser.registerCommand("dump", &runDumpCommand);
   CommandParser.registerCommand("load", &runLoadCommand);
+  CommandParser.registerCommand("materialize", &runMaterializeCommand);
   CommandParser.registerCommand("quit", &runQuitCommand);
   CommandParser.registerCommand("sections", &runSectionsCommand);
   CommandParser.registerCommand("symbols", &runSymbolsCommand);
   CommandParser.registerCommand("save", &runSaveCommand);
+  CommandParser.registerCommand("stats", &runStatsCommand);
+  CommandParser.registerCommand("coverage", &runCoverageCommand);
   // TODO:
   // CommandParser.registerCommand("cfg", &runCfgCommand);
   // CommandParser.registerCommand("functions", &runFunctionsCommand);
@@ -1073,6 +1345,14 @@ int main(int argc, char *argv[]) {
   cl::ParseCommandLineOptions(argc, argv, "DIsassembler SHell");
 
   initializeCommands();
+  if (Optimize || !OptPasses.empty()) {
+    std::string Error;
+    if (!Optimizer.parse(OptPasses.empty() ? OptPipeline::DefaultPasses
+        : OptPasses, Error)) {
+      errs() << ProgramName << ": " << Error << ".\n";
+      return 1;
+    }
+  }
 
   if (std::error_code Err = loadBinary(InputFileName.getValue())) {
     errs() << ProgramName << ": Could not open the file '"
@@ -1083,18 +1363,24 @@ int main(int argc, char *argv[]) {
      && StrippedBinary){
     isStripped = true;
     outs() << "File is Stripped\n";
-    SDAS = new StrippedDisassembler(DAS, TripleName);
+    SDAS = new StrippedDisassembler(DAS,
+      MCD->getTargetMachine()->getTargetTriple());
     SDAS->findStrippedMain();
-    SDAS->functionsIterator(SDAS->getStrippedSection(".text"));
+    // Decodes the section once, seeded from main and the prologues in the
+    // raw bytes.
+    SDAS->findStrippedFunctions(SDAS->getStrippedSection(".text"));
+    outs() << SDAS->getFunctionExtents().size() << " functions found, "
+           << SDAS->getNumPrologueFunctions() << " of them from "
+           << SDAS->getNumPrologues() << " prologue matches\n";
     //Also print stripped graph
     if(printGraph)
-      SDAS->getStrippedGraph()->printGraph();
-    SDAS->getStrippedGraph()->correctHeadNodes();
+      SDAS->printCFG();
   }
 
 
 
   CommandParser.runShell(ProgramName);
+  endStreaming();
   delete SDAS;
   return 0;
 }
@@ -11,6 +11,15 @@
 // given architecture. These binaries can then be run on Fracture for testing
 // purposes.
 //
+// With -archive, the instructions are encoded on several threads and written
+// to a single indexed archive instead of one file per instruction. The
+// archive format (all integers little endian) is:
+//   "FRINSTS1", u32 number of entries,
+//   per entry: u32 opcode, u32 name offset, u32 data offset, u32 data size,
+//   the NUL terminated opcode names, then the encodings.
+// Offsets are from the start of the file, and each encoding is followed by
+// the return instruction, exactly as in the per-instruction binaries.
+//
 // NOTE: Fracture must be able to handle a valid return opcode correctly in
 //       order for these binaries to be useful
 //          -For ARM:        BX_RET
@@ -47,6 +56,7 @@
 #include "llvm/Support/TargetRegistry.h"
 #include "llvm/Support/TargetSelect.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/ADT/SmallString.h"
 #include "../lib/Target/ARM/InstPrinter/ARMInstPrinter.h"
 #include "../lib/Target/X86/InstPrinter/X86IntelInstPrinter.h"
 #include "../lib/Target/PowerPC/InstPrinter/PPCInstPrinter.h"
@@ -68,6 +78,13 @@
 /*#define GET_INSTRINFO_ENUM
 #include "../lib/Target/Mips/MipsGenInstrInfo.inc"*/
 
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
 using namespace llvm;
 
 //===----------------------------------------------------------------------===//
@@ -83,13 +100,29 @@ struct MIBplus {
 //Global output and error stream for sending info to the console
 raw_ostream &OS = outs(), &ES = errs();
 //Global file streams for the Result File, Unsupported File, and Supported File
-raw_fd_ostream *RS, *US, *SS;
+//These are per thread, so that archive workers can log to their own buffers
+thread_local raw_ostream *RS = NULL, *US = NULL, *SS = NULL;
+
+//One block of op codes encoded by an archive worker, with its log output
+struct ArchiveChunk {
+    unsigned Begin, End;
+    std::string Res, Unsup, Sup;
+};
+
+//The encoding of one instruction followed by the return instruction
+struct EncodedInst {
+    bool Valid;
+    SmallString<16> Bytes;
+};
 
 //===----------------------------------------------------------------------===//
 // Function Declarations
 //===----------------------------------------------------------------------===//
 
 void makeBins(std::string TripleName, std::string DirName, bool printAsm);
+void makeArchive(std::string TripleName, std::string FileName,
+                                                        unsigned NumThreads);
+MCInstBuilder *buildRET(std::string TripleName, unsigned &lastInst);
 MIBplus buildMI(std:: string triple, const MCInstrInfo *MII,
                                             MCContext *MCCtx, unsigned op);
 MIBplus buildARMMI(const MCInstrInfo *MII, MCContext *MCCtx, unsigned op);
@@ -125,7 +158,10 @@ int main(int argc, char* argv[])
                   "-res\t- creates a file with the results of every " <<
                   "instruction\n\t\t-unsup\t- creates a file listing every " <<
                   "unsupported instruction\n\t\t-sup\t- creates a file " <<
-                  "listing every supported instruction\n\t" <<
+                  "listing every supported instruction\n\t\t-archive\t- " <<
+                  "encodes on several threads into one indexed archive " <<
+                  "file\n\t\t-j <n>\t- number of threads for -archive" <<
+                  "\n\t" <<
                   "arch:\n\t\t-arm\t- specifies ARM architecture\n\t\t-i386" <<
                   "\t- specifies x86 32-bit architecture\n\t\t-powerpc64\t-" <<
                   " specifies PowerPC 64-bit architecture\n\t\t-mips\t- " <<
@@ -136,6 +172,8 @@ int main(int argc, char* argv[])
     Arch arch = NONE;
     bool printAsm = false;
     bool res = false, sup = false, unsup = false;
+    bool archive = false;
+    unsigned NumThreads = std::thread::hardware_concurrency();
     std::error_code ErrMsg;
     for(int i = 1; i < argc; i++) {
         arg = argv[i];
@@ -147,6 +185,15 @@ int main(int argc, char* argv[])
             unsup = true;
         } else if(arg == "-sup") {
             sup = true;
+        } else if(arg == "-archive") {
+            archive = true;
+        } else if(arg == "-j") {
+            if(i + 1 == argc || atoi(argv[i + 1]) <= 0) {
+                ES << "mkAllInsts: -j needs a thread count." <<
+                                            " Use -help for more info.\n";
+                return 2;
+            }
+            NumThreads = atoi(argv[++i]);
         } else if(arch != NONE) {
             if(arg == "-arm" || arg == "-i386" ||
                     arg == "-powerpc64" || arg == "-mips") {
@@ -171,6 +218,13 @@ int main(int argc, char* argv[])
         }
     }
     
+    if(archive && printAsm) {
+        ES << "mkAllInsts: -archive holds binaries and cannot be used with" <<
+                                        " -asm. Use -help for more info.\n";
+        return 2;
+    }
+    if(NumThreads == 0) { NumThreads = 1; }
+
     //Initialize instruction info
     InitializeAllTargetInfos();
     
@@ -182,40 +236,46 @@ int main(int argc, char* argv[])
         return 3;
     } else if(arch == arm) {
         filePre = "arm-";
-        system("rm -rf armBins/");
-        system("rm -rf armAsms/");
-        if(printAsm) {
-            system("mkdir armAsms");
-            DirName = " armAsms/";
-        } else {
-            system("mkdir armBins");
-            DirName = " armBins/";
+        if(!archive) {
+            system("rm -rf armBins/");
+            system("rm -rf armAsms/");
+            if(printAsm) {
+                system("mkdir armAsms");
+                DirName = " armAsms/";
+            } else {
+                system("mkdir armBins");
+                DirName = " armBins/";
+            }
         }
         TripleName = "arm-unknown-unknown";
         LLVMInitializeARMTargetMC();
     } else if(arch == i386) {
         filePre = "i386-";
-        system("rm -rf i386Bins/");
-        system("rm -rf i386Asms/");
-        if(printAsm) {
-            system("mkdir i386Asms");
-            DirName = " i386Asms/";
-        } else {
-            system("mkdir i386Bins");
-            DirName = " i386Bins/";
+        if(!archive) {
+            system("rm -rf i386Bins/");
+            system("rm -rf i386Asms/");
+            if(printAsm) {
+                system("mkdir i386Asms");
+                DirName = " i386Asms/";
+            } else {
+                system("mkdir i386Bins");
+                DirName = " i386Bins/";
+            }
         }
         TripleName = "i386-unknown-unknown";
         LLVMInitializeX86TargetMC();
     } else if(arch == powerpc64) {
         filePre = "powerpc64-";
-        system("rm -rf powerpc64Bins/");
-        system("rm -rf powerpc64Asms/");
-        if(printAsm) {
-            system("mkdir powerpc64Asms");
-            DirName = " powerpc64Asms/";
-        } else {
-            system("mkdir powerpc64Bins");
-            DirName = " powerpc64Bins/";
+        if(!archive) {
+            system("rm -rf powerpc64Bins/");
+            system("rm -rf powerpc64Asms/");
+            if(printAsm) {
+                system("mkdir powerpc64Asms");
+                DirName = " powerpc64Asms/";
+            } else {
+                system("mkdir powerpc64Bins");
+                DirName = " powerpc64Bins/";
+            }
         }
         TripleName = "powerpc64-unknown-unknown";
         LLVMInitializePowerPCTargetMC();
@@ -248,7 +308,11 @@ int main(int argc, char* argv[])
     }
 
     //Call function to create the binaries
-    makeBins(TripleName, DirName, printAsm);
+    if(archive) {
+        makeArchive(TripleName, filePre + "insts.bin", NumThreads);
+    } else {
+        makeBins(TripleName, DirName, printAsm);
+    }
 
     if(RS) { delete RS; }
     if(US) { delete US; }
@@ -279,26 +343,8 @@ void makeBins(std::string TripleName, std::string DirName, bool printAsm) {
     MCCodeEmitter *MCE = TheTarget->createMCCodeEmitter(*MII, *MRI, *STI,
                                                                     *MCCtx);
     //Create a valid return instruction for the given architecture
-    MCInstBuilder *RET;
     unsigned lastInst;
-    if(TripleName == "arm-unknown-unknown") {
-        lastInst = ARM::INSTRUCTION_LIST_END;
-        RET = new MCInstBuilder(ARM::BX_RET);
-        RET->addImm(14);
-        RET->addReg(0);
-    } else if(TripleName == "i386-unknown-unknown") {
-        lastInst = X86::INSTRUCTION_LIST_END;
-        RET = new MCInstBuilder(X86::RETL);
-    } else if(TripleName == "powerpc64-unknown-unknown") {
-        lastInst = PPC::INSTRUCTION_LIST_END;
-        RET = new MCInstBuilder(PPC::BLR);
-    /*} else if(TripleName == *MIPS triple*) {
-        lastInst = Mips::INSTRUCTION_LIST_END;
-        RET = new MCInstBuilder(*MIPS return*);*/
-    } else {
-        ES << "mkAllInsts::makeBins: unknown triple name received\n";
-        abort();
-    }
+    MCInstBuilder *RET = buildRET(TripleName, lastInst);
     
     //Create an array to keep track of used file names
     std::string *flist = new std::string[lastInst];
@@ -396,6 +442,205 @@ void makeBins(std::string TripleName, std::string DirName, bool printAsm) {
     //delete TheTarget; <-FIXME Segfaults when uncommented. Problematic?
 }
 
+//===----------------------------------------------------------------------===//
+// * buildRET - Returns a valid return instruction for the given architecture,
+// *            and sets lastInst to the number of op codes it has
+MCInstBuilder *buildRET(std::string TripleName, unsigned &lastInst)
+{
+    MCInstBuilder *RET;
+    if(TripleName == "arm-unknown-unknown") {
+        lastInst = ARM::INSTRUCTION_LIST_END;
+        RET = new MCInstBuilder(ARM::BX_RET);
+        RET->addImm(14);
+        RET->addReg(0);
+    } else if(TripleName == "i386-unknown-unknown") {
+        lastInst = X86::INSTRUCTION_LIST_END;
+        RET = new MCInstBuilder(X86::RETL);
+    } else if(TripleName == "powerpc64-unknown-unknown") {
+        lastInst = PPC::INSTRUCTION_LIST_END;
+        RET = new MCInstBuilder(PPC::BLR);
+    /*} else if(TripleName == *MIPS triple*) {
+        lastInst = Mips::INSTRUCTION_LIST_END;
+        RET = new MCInstBuilder(*MIPS return*);*/
+    } else {
+        ES << "mkAllInsts::buildRET: unknown triple name received\n";
+        abort();
+    }
+    return RET;
+}
+
+//===----------------------------------------------------------------------===//
+// * encodeChunks - Archive worker. Takes chunks of op codes until none are
+// *                left, and encodes each instruction followed by RET. The
+// *                MCContext, code emitter and printer are not thread safe,
+// *                so every worker makes its own.
+static void encodeChunks(std::string TripleName, const Target *TheTarget,
+                const MCInstrInfo *MII, const MCRegisterInfo *MRI,
+                const MCAsmInfo *AsmInfo, const MCSubtargetInfo *STI,
+                const MCInst *RET, bool logRes, bool logUnsup, bool logSup,
+                std::vector<ArchiveChunk> *Chunks, std::atomic<unsigned> *Next,
+                std::vector<EncodedInst> *Insts)
+{
+    MCObjectFileInfo *MCOFI = new MCObjectFileInfo();
+    MCContext *MCCtx = new MCContext(AsmInfo, MRI, MCOFI);
+    MCInstPrinter *MIP = getTargetInstPrinter(TripleName,AsmInfo,MII,MRI,STI);
+    MCCodeEmitter *MCE = TheTarget->createMCCodeEmitter(*MII, *MRI, *STI,
+                                                                    *MCCtx);
+    SmallVector<MCFixup, 4> Fixups;
+    StringRef annot = "";
+
+    for(unsigned c = (*Next)++; c < Chunks->size(); c = (*Next)++) {
+        ArchiveChunk &Chunk = (*Chunks)[c];
+        raw_string_ostream ResOut(Chunk.Res), UnsupOut(Chunk.Unsup),
+                                                    SupOut(Chunk.Sup);
+        RS = logRes ? &ResOut : NULL;
+        US = logUnsup ? &UnsupOut : NULL;
+        SS = logSup ? &SupOut : NULL;
+
+        for(unsigned op = Chunk.Begin; op < Chunk.End; op++) {
+            MIBplus MIBP = buildMI(TripleName, MII, MCCtx, op);
+            if(!MIBP.MIB) { continue; }
+
+            MCInst MI = static_cast<MCInst&>(*(MIBP.MIB));
+            if(RS && MIBP.asmPrintable) {
+                MIP->printInst(&MI, *RS, annot);
+                *RS << "\n";
+            }
+            if(SS) {
+                if(MIBP.asmPrintable) {
+                    MIP->printInst(&MI, *SS, annot);
+                    *SS << "\n";
+                } else {
+                    *SS << "\tCANNOT PRINT TO ASM!\n";
+                }
+            }
+
+            EncodedInst &E = (*Insts)[op];
+            raw_svector_ostream BytesOut(E.Bytes);
+            MCE->EncodeInstruction(MI, BytesOut, Fixups, *STI);
+            MCE->EncodeInstruction(*RET, BytesOut, Fixups, *STI);
+            BytesOut.flush();
+            Fixups.clear();
+            E.Valid = true;
+            delete MIBP.MIB;
+        }
+        ResOut.flush();
+        UnsupOut.flush();
+        SupOut.flush();
+    }
+    RS = NULL; US = NULL; SS = NULL;
+
+    delete MCE;
+    delete MIP;
+    delete MCCtx;
+    delete MCOFI;
+}
+
+static void writeLE32(raw_ostream &Out, uint32_t Value) {
+    for(unsigned i = 0; i < 4; i++) {
+        Out << (char)((Value >> (8 * i)) & 0xff);
+    }
+}
+
+//===----------------------------------------------------------------------===//
+// * makeArchive - Encodes every instruction on a given architecture on
+// *               NumThreads threads, and writes them to one indexed archive
+void makeArchive(std::string TripleName, std::string FileName,
+                                                        unsigned NumThreads) {
+    //Create the LLVM objects shared by the workers; they are only read
+    std::string ErrMsg;
+    const Target *TheTarget = TargetRegistry::lookupTarget(TripleName, ErrMsg);
+    const MCInstrInfo *MII = TheTarget->createMCInstrInfo();
+    const MCRegisterInfo *MRI = TheTarget->createMCRegInfo(TripleName);
+    const MCAsmInfo *AsmInfo = TheTarget->createMCAsmInfo(*MRI, TripleName);
+    StringRef CPUName = "generic", Features = "";
+    const MCSubtargetInfo *STI = TheTarget->createMCSubtargetInfo(TripleName,
+                                                            CPUName, Features);
+    unsigned lastInst;
+    MCInstBuilder *RET = buildRET(TripleName, lastInst);
+    MCInst RETInst = static_cast<MCInst&>(*RET);
+
+    //Workers take fixed size chunks of op codes, and the logs are written
+    //back in chunk order, so the result files match the per-file mode
+    const unsigned ChunkSize = 256;
+    std::vector<ArchiveChunk> Chunks;
+    for(unsigned op = 0; op < lastInst; op += ChunkSize) {
+        ArchiveChunk Chunk;
+        Chunk.Begin = op;
+        Chunk.End = std::min(op + ChunkSize, lastInst);
+        Chunks.push_back(Chunk);
+    }
+    EncodedInst Empty;
+    Empty.Valid = false;
+    std::vector<EncodedInst> Insts(lastInst, Empty);
+    std::atomic<unsigned> Next(0);
+
+    std::vector<std::thread> Workers;
+    for(unsigned i = 0; i < NumThreads; i++) {
+        Workers.push_back(std::thread(encodeChunks, TripleName, TheTarget,
+                    MII, MRI, AsmInfo, STI, &RETInst, RS != NULL, US != NULL,
+                    SS != NULL, &Chunks, &Next, &Insts));
+    }
+    for(unsigned i = 0; i < Workers.size(); i++) {
+        Workers[i].join();
+    }
+
+    for(unsigned c = 0; c < Chunks.size(); c++) {
+        if(RS) { *RS << Chunks[c].Res; }
+        if(US) { *US << Chunks[c].Unsup; }
+        if(SS) { *SS << Chunks[c].Sup; }
+    }
+
+    //Lay out the index, the name table and the encodings
+    std::vector<unsigned> Ops;
+    uint32_t NameSize = 0, DataSize = 0;
+    for(unsigned op = 0; op < lastInst; op++) {
+        if(!Insts[op].Valid) { continue; }
+        Ops.push_back(op);
+        NameSize += strlen(MII->getName(op)) + 1;
+        DataSize += Insts[op].Bytes.size();
+    }
+    uint32_t NameOffset = 12 + 16 * Ops.size();
+    //Keep the encodings word aligned for readers that map the file
+    uint32_t DataOffset = (NameOffset + NameSize + 3) & ~3U;
+
+    std::error_code ErrCd;
+    raw_fd_ostream AS(FileName.c_str(), ErrCd, sys::fs::F_None);
+    if(ErrCd) {
+        ES << "mkAllInsts: cannot open '" << FileName << "': " <<
+                                                    ErrCd.message() << "\n";
+    } else {
+        AS.write("FRINSTS1", 8);
+        writeLE32(AS, Ops.size());
+        uint32_t NameAt = NameOffset, DataAt = DataOffset;
+        for(unsigned i = 0; i < Ops.size(); i++) {
+            writeLE32(AS, Ops[i]);
+            writeLE32(AS, NameAt);
+            writeLE32(AS, DataAt);
+            writeLE32(AS, Insts[Ops[i]].Bytes.size());
+            NameAt += strlen(MII->getName(Ops[i])) + 1;
+            DataAt += Insts[Ops[i]].Bytes.size();
+        }
+        for(unsigned i = 0; i < Ops.size(); i++) {
+            AS << MII->getName(Ops[i]) << '\0';
+        }
+        for(uint32_t i = NameOffset + NameSize; i < DataOffset; i++) {
+            AS << '\0';
+        }
+        for(unsigned i = 0; i < Ops.size(); i++) {
+            AS << Insts[Ops[i]].Bytes.str();
+        }
+        OS << "mkAllInsts: wrote " << Ops.size() << " instructions (" <<
+                                DataSize << " bytes) to " << FileName << "\n";
+    }
+
+    delete RET;
+    delete STI;
+    delete AsmInfo;
+    delete MRI;
+    delete MII;
+}
+
 //===----------------------------------------------------------------------===//
 // * buildMI - Calls the appropriate target function for the given triple
 // *